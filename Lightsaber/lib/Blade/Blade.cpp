@@ -0,0 +1,78 @@
+#include "Blade.h"
+
+
+Blade::Blade(uint16_t numPixels) : _numPixels(numPixels) {
+}
+
+
+bool Blade::setNumPixels(uint16_t numPixels) {
+  if (_state != BLADE_OFF)
+    return false;
+  _numPixels = numPixels;
+  return true;
+}
+
+
+bool Blade::start(BladeState state, uint32_t now, uint32_t duration, IgnitionCurve curve) {
+  _state = state;
+  _startTime = now;
+  _duration = duration > 0xffff ? 0xffff : duration == 0 ? 1 : duration;
+  _curve = curve;
+  return true;
+}
+
+
+bool Blade::ignite(uint32_t now, uint32_t duration, IgnitionCurve curve) {
+  if (_state != BLADE_OFF)
+    return false;
+  return start(BLADE_IGNITING, now, duration, curve);
+}
+
+
+bool Blade::retract(uint32_t now, uint32_t duration, IgnitionCurve curve) {
+  if (_state != BLADE_ON)
+    return false;
+  return start(BLADE_RETRACTING, now, duration, curve);
+}
+
+
+// number of lit pixels after 'elapsed' ms of the current animation
+uint16_t Blade::litAt(uint32_t elapsed) const {
+  uint32_t t = (elapsed << 16) / _duration;          // animation time in Q16
+  if (_state == BLADE_RETRACTING)
+    t = CURVE_ONE - t;                               // run the curve backwards
+  uint32_t length = curveAt(_curve, t);              // blade length in Q16
+  return (uint16_t)((length * _numPixels + 0x8000) >> 16);
+}
+
+
+bool Blade::update(uint32_t now) {
+  uint16_t lit = _lit;
+
+  switch (_state) {
+    case BLADE_IGNITING:
+    case BLADE_RETRACTING: {
+      uint32_t elapsed = now - _startTime;
+      if (elapsed >= _duration) {
+        if (_state == BLADE_IGNITING) {
+          _state = BLADE_ON;
+          lit = _numPixels;
+        } else {
+          _state = BLADE_OFF;
+          lit = 0;
+        }
+      } else {
+        lit = litAt(elapsed);
+      }
+      break;
+    }
+    case BLADE_ON:
+    case BLADE_OFF:
+      break;
+  }
+
+  if (lit == _lit)
+    return false;
+  _lit = lit;
+  return true;
+}
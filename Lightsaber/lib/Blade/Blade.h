@@ -0,0 +1,61 @@
+#ifndef Blade_h
+#define Blade_h
+
+#include <stdint.h>
+
+#include "IgnitionCurve.h"
+
+//
+// Tick driven blade state machine.
+//
+// The blade does not own a clock; the caller passes the current time in
+// milliseconds to every call. On the device that is millis(), on the host
+// any fake clock will do, so ignition timing can be checked off-device.
+//
+// Nothing in here blocks: update() does a bounded amount of work and returns,
+// so button input, audio copying and LED frames can interleave in loop().
+//
+enum BladeState {
+  BLADE_OFF,
+  BLADE_IGNITING,
+  BLADE_ON,
+  BLADE_RETRACTING
+};
+
+class Blade {
+  public:
+    Blade(uint16_t numPixels);
+
+    // start ignition / retraction, returns false if the blade is not in a
+    // state where this makes sense (e.g. ignite while already on).
+    // Durations are limited to 65535 ms, retraction runs the curve backwards.
+    bool ignite(uint32_t now, uint32_t duration, IgnitionCurve curve = CURVE_SQRT);
+    bool retract(uint32_t now, uint32_t duration, IgnitionCurve curve = CURVE_SQRT);
+
+    // change the blade length, only while the blade is off
+    bool setNumPixels(uint16_t numPixels);
+
+    // advance the state machine, returns true if the number of lit pixels
+    // changed and the strip needs a new frame
+    bool update(uint32_t now);
+
+    BladeState state() const { return _state; }
+    uint16_t lit() const { return _lit; }
+    uint16_t numPixels() const { return _numPixels; }
+    bool isOn() const { return _state == BLADE_ON; }
+    bool isOff() const { return _state == BLADE_OFF; }
+    bool busy() const { return _state == BLADE_IGNITING || _state == BLADE_RETRACTING; }
+
+  private:
+    bool start(BladeState state, uint32_t now, uint32_t duration, IgnitionCurve curve);
+    uint16_t litAt(uint32_t elapsed) const;
+
+    uint16_t _numPixels;
+    uint16_t _lit = 0;
+    BladeState _state = BLADE_OFF;
+    uint32_t _startTime = 0;
+    uint32_t _duration = 0;
+    IgnitionCurve _curve = CURVE_SQRT;
+};
+
+#endif
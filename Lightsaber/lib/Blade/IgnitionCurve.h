@@ -0,0 +1,99 @@
+#ifndef IgnitionCurve_h
+#define IgnitionCurve_h
+
+#include <stdint.h>
+
+#include "FixedMath.h"
+
+//
+// Ignition / retraction easing curves as fixed point lookup tables.
+//
+// Each curve maps the animation time t (0..1) to the blade length (0..1),
+// both in Q16. The tables are computed by the compiler, at runtime a curve
+// lookup is two table reads and a linear interpolation, no floating point.
+//
+enum IgnitionCurve {
+  CURVE_SQRT,           // fast start, slow end (the classic one)
+  CURVE_EASE_IN_OUT,    // smoothstep
+  CURVE_BOUNCE,         // overshoots the hilt end a few times
+  CURVE_FLICKER_IN,     // sqrt with short dropouts while it extends
+  CURVE_COUNT
+};
+
+#define CURVE_SHIFT 6                   // 64 segments per curve
+#define CURVE_STEPS (1 << CURVE_SHIFT)
+#define CURVE_ONE   65535               // 1.0 in Q16
+
+namespace curve {
+
+struct Table {
+  uint16_t v[CURVE_STEPS + 1];
+};
+
+constexpr double easeInOut(double t) {
+  return t * t * (3 - 2 * t);
+}
+
+constexpr double bounce(double t) {
+  // easeOutBounce, ends at 1 after three shrinking bounces
+  if (t < 1 / 2.75)
+    return 7.5625 * t * t;
+  if (t < 2 / 2.75) {
+    t -= 1.5 / 2.75;
+    return 7.5625 * t * t + 0.75;
+  }
+  if (t < 2.5 / 2.75) {
+    t -= 2.25 / 2.75;
+    return 7.5625 * t * t + 0.9375;
+  }
+  t -= 2.625 / 2.75;
+  return 7.5625 * t * t + 0.984375;
+}
+
+constexpr double flickerIn(int step, double t) {
+  // fixed pseudo random dropouts on the way out, none at the ends
+  uint32_t r = (uint32_t)step * 2654435761u;
+  double drop = (step > 2 && step < CURVE_STEPS - 2 && (r >> 28) < 4) ? 0.6 : 1.0;
+  return constexprSqrt(t) * drop;
+}
+
+constexpr uint16_t toQ16(double v) {
+  return v <= 0 ? 0 : v >= 1 ? CURVE_ONE : (uint16_t)(v * CURVE_ONE + 0.5);
+}
+
+constexpr Table make(IgnitionCurve c) {
+  Table table{};
+  for (int i = 0; i <= CURVE_STEPS; i++) {
+    double t = (double)i / CURVE_STEPS;
+    double v = c == CURVE_SQRT ? constexprSqrt(t)
+             : c == CURVE_EASE_IN_OUT ? easeInOut(t)
+             : c == CURVE_BOUNCE ? bounce(t)
+             : flickerIn(i, t);
+    table.v[i] = toQ16(v);
+  }
+  return table;
+}
+
+constexpr Table tables[CURVE_COUNT] = {
+  make(CURVE_SQRT),
+  make(CURVE_EASE_IN_OUT),
+  make(CURVE_BOUNCE),
+  make(CURVE_FLICKER_IN),
+};
+
+} // namespace curve
+
+
+// blade length in Q16 for the time t in Q16 (0..CURVE_ONE)
+inline uint16_t curveAt(IgnitionCurve c, uint32_t t) {
+  const uint16_t *v = curve::tables[c < CURVE_COUNT ? c : CURVE_SQRT].v;
+  if (t >= CURVE_ONE)
+    return v[CURVE_STEPS];
+  uint32_t index = t >> (16 - CURVE_SHIFT);
+  uint32_t frac = t & ((1 << (16 - CURVE_SHIFT)) - 1);
+  int32_t a = v[index];
+  int32_t b = v[index + 1];
+  return (uint16_t)(a + (((b - a) * (int32_t)frac) >> (16 - CURVE_SHIFT)));
+}
+
+#endif
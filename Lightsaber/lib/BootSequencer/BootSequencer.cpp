@@ -0,0 +1,74 @@
+#include <stdio.h>
+
+#include "BootSequencer.h"
+
+
+int BootSequencer::add(const char *name, Phase phase, uint32_t dependsOn, bool lazy) {
+  if (_count == BOOT_MAX_PHASES)
+    return -1;
+  _phases[_count] = { name, phase, dependsOn, lazy, PENDING, 0, 0 };
+  return _count++;
+}
+
+
+bool BootSequencer::run() {
+  bool ok = true;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (!_phases[i].lazy && !ensure(i))
+      ok = false;
+  }
+  return ok;
+}
+
+
+bool BootSequencer::ensure(int id) {
+  if (id < 0 || id >= _count)
+    return false;
+
+  Entry &e = _phases[id];
+  if (e.state == DONE)
+    return true;
+  if (e.state != PENDING)     // failed or skipped before, or a dependency cycle
+    return false;
+
+  e.state = RUNNING;
+  for (uint8_t dep = 0; dep < _count; dep++) {
+    if ((e.dependsOn & (1u << dep)) && !ensure(dep)) {
+      e.state = SKIPPED;
+      return false;
+    }
+  }
+
+  uint32_t start = _clock();
+  if (!_started) {
+    _origin = start;
+    _started = true;
+  }
+  bool ok = e.phase == nullptr || e.phase();
+  e.duration = _clock() - start;
+  e.start = start - _origin;
+  e.state = ok ? DONE : FAILED;
+  return ok;
+}
+
+
+void BootSequencer::report(Print print) const {
+  static const char *states[] = { "lazy", "running", "ok", "FAILED", "skipped" };
+  char line[64];
+  uint32_t total = 0;
+
+  print("phase          start us    time us  state");
+  for (uint8_t i = 0; i < _count; i++) {
+    const Entry &e = _phases[i];
+    if (e.state == DONE || e.state == FAILED) {
+      snprintf(line, sizeof(line), "%-12s %10lu %10lu  %s", e.name,
+               (unsigned long)e.start, (unsigned long)e.duration, states[e.state]);
+      total += e.duration;
+    } else {
+      snprintf(line, sizeof(line), "%-12s %10s %10s  %s", e.name, "-", "-", states[e.state]);
+    }
+    print(line);
+  }
+  snprintf(line, sizeof(line), "%-12s %10s %10lu", "total", "", (unsigned long)total);
+  print(line);
+}
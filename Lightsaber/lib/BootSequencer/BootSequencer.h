@@ -0,0 +1,62 @@
+#ifndef BootSequencer_h
+#define BootSequencer_h
+
+#include <stdint.h>
+
+#define BOOT_MAX_PHASES 16
+
+//
+// Runs the init phases of the firmware in dependency order and times them.
+//
+// Every phase names the phases it depends on (bit mask of phase ids).
+// run() executes all eager phases, pulling in their dependencies first.
+// Lazy phases are skipped at boot and only run on the first ensure(),
+// e.g. audio on the first ignition. A failed phase fails everything that
+// depends on it (skipped). report() prints one line per phase with its
+// start time and duration in microseconds.
+//
+// The clock is passed in, micros() on the device or a fake on the host.
+//
+class BootSequencer {
+  public:
+    typedef bool (*Phase)();
+    typedef uint32_t (*Clock)();
+    typedef void (*Print)(const char *line);
+
+    enum State : uint8_t { PENDING, RUNNING, DONE, FAILED, SKIPPED };
+
+    BootSequencer(Clock clock) : _clock(clock) {}
+
+    // returns the phase id (0..BOOT_MAX_PHASES-1) or -1 if the table is full
+    int add(const char *name, Phase phase, uint32_t dependsOn = 0, bool lazy = false);
+
+    // run all eager phases, true if none failed
+    bool run();
+
+    // run a phase and its dependencies now unless already done
+    bool ensure(int id);
+
+    State state(int id) const { return _phases[id].state; }
+    bool done(int id) const { return _phases[id].state == DONE; }
+
+    void report(Print print) const;
+
+  private:
+    struct Entry {
+      const char *name;
+      Phase phase;
+      uint32_t dependsOn;
+      bool lazy;
+      State state;
+      uint32_t start;      // micros since the first phase started
+      uint32_t duration;   // micros
+    };
+
+    Clock _clock;
+    Entry _phases[BOOT_MAX_PHASES];
+    uint8_t _count = 0;
+    bool _started = false;
+    uint32_t _origin = 0;
+};
+
+#endif
@@ -0,0 +1,16 @@
+#include "Color.h"
+
+
+void ColorLut::setBrightness(uint8_t brightness) {
+  uint32_t scale = brightness + 1;
+
+  _brightness = brightness;
+  for (int i = 0; i < 256; i++)
+    _lut[i] = ((uint32_t)colorGamma::table.v[i] * 255 * scale + (COLOR_GAMMA_ONE << 7)) / ((uint32_t)COLOR_GAMMA_ONE << 8);
+}
+
+
+void ColorLut::apply(const uint32_t *in, uint32_t *out, uint16_t count) const {
+  for (uint16_t i = 0; i < count; i++)
+    out[i] = map(in[i]);
+}
@@ -0,0 +1,97 @@
+#ifndef Color_h
+#define Color_h
+
+#include <stdint.h>
+
+#include "FixedMath.h"
+
+//
+// Packed color math for the LED frame buffer.
+//
+// Pixels are stored as 0x00RRGGBB. Scaling and blending work on red and
+// blue in one multiply (0x00ff00ff, each channel has 8 bits of headroom for
+// the product) and on green in a second one, so no channel is ever
+// unpacked. Gamma and brightness are left out of the frame buffer, the
+// ColorLut applies both on the way to the strip.
+//
+
+// pack a color the way the frame buffer stores it
+inline uint32_t rgb(uint8_t r, uint8_t g, uint8_t b) {
+  return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+// scale all channels of a color, 256 = 1.0
+inline uint32_t scaleColor(uint32_t color, uint16_t scale) {
+  uint32_t rb = ((color & 0xff00ff) * scale >> 8) & 0xff00ff;
+  uint32_t g = ((color & 0x00ff00) * scale >> 8) & 0x00ff00;
+  return rb | g;
+}
+
+// mix src over dst, alpha 0..256 (256 = src only)
+inline uint32_t blendColor(uint32_t dst, uint32_t src, uint16_t alpha) {
+  uint16_t inv = 256 - alpha;
+  uint32_t rb = ((src & 0xff00ff) * alpha + (dst & 0xff00ff) * inv) >> 8;
+  uint32_t g = ((src & 0x00ff00) * alpha + (dst & 0x00ff00) * inv) >> 8;
+  return (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+// add two colors, channels saturate at 255
+inline uint32_t addColor(uint32_t a, uint32_t b) {
+  uint32_t rb = (a & 0xff00ff) + (b & 0xff00ff);     // 9 bits per channel
+  uint32_t g = (a & 0x00ff00) + (b & 0x00ff00);
+  uint32_t rbCarry = rb & 0x1000100;
+  uint32_t gCarry = g & 0x10000;
+  rb |= rbCarry - (rbCarry >> 8);                    // carry set: channel to 0xff
+  g |= gCarry - (gCarry >> 8);
+  return (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+#define COLOR_GAMMA_ONE 65535    // 1.0 in Q16
+
+namespace colorGamma {
+
+struct Table {
+  uint16_t v[256];
+};
+
+// gamma 2.5, x^2 * sqrt(x), close to what WS2812 LEDs need
+constexpr Table make() {
+  Table table{};
+  for (int i = 0; i < 256; i++) {
+    double x = i / 255.0;
+    table.v[i] = (uint16_t)(x * x * constexprSqrt(x) * COLOR_GAMMA_ONE + 0.5);
+  }
+  return table;
+}
+
+constexpr Table table = make();
+
+}
+
+//
+// Output lookup table: gamma correction and brightness in one byte lookup
+// per channel. Rebuilt only when the brightness changes.
+//
+class ColorLut {
+  public:
+    ColorLut() { setBrightness(255); }
+
+    // 0..255, 255 is full brightness
+    void setBrightness(uint8_t brightness);
+    uint8_t brightness() const { return _brightness; }
+
+    uint32_t map(uint32_t color) const {
+      return ((uint32_t)_lut[color >> 16 & 0xff] << 16) |
+             ((uint32_t)_lut[color >> 8 & 0xff] << 8) |
+             _lut[color & 0xff];
+    }
+
+    // map count pixels from in to out
+    void apply(const uint32_t *in, uint32_t *out, uint16_t count) const;
+
+  private:
+    uint8_t _lut[256];
+    uint8_t _brightness = 0;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "EffectEngine.h"
+#include "StripDriver.h"
+
+
+int EffectEngine::start(const Effect &effect, uint32_t now) {
+  for (int i = 0; i < EFFECT_MAX; i++) {
+    if (!_slots[i].active) {
+      _slots[i] = { effect, now, true };
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+void EffectEngine::stop(int slot) {
+  if (slot >= 0 && slot < EFFECT_MAX)
+    _slots[slot].active = false;
+}
+
+
+void EffectEngine::stopAll(uint8_t type) {
+  for (Slot &slot : _slots) {
+    if (slot.effect.type == type)
+      slot.active = false;
+  }
+}
+
+
+bool EffectEngine::active(uint8_t type) const {
+  for (const Slot &slot : _slots) {
+    if (slot.active && slot.effect.type == type)
+      return true;
+  }
+  return false;
+}
+
+
+uint8_t EffectEngine::activeCount() const {
+  uint8_t n = 0;
+  for (const Slot &slot : _slots)
+    n += slot.active;
+  return n;
+}
+
+
+uint16_t EffectEngine::fade(const Slot &slot, uint32_t now) const {
+  uint32_t duration = slot.effect.duration;
+  if (duration == 0)
+    return 256;
+  uint32_t elapsed = now - slot.start;
+  return elapsed >= duration ? 0 : 256 - elapsed * 256 / duration;
+}
+
+
+uint32_t EffectEngine::noise() {
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  return _seed;
+}
+
+
+void EffectEngine::render(uint32_t now, uint32_t *frame, uint16_t count, uint16_t lit, uint16_t level) {
+  if (lit > count)
+    lit = count;
+
+  for (Slot &slot : _slots) {
+    if (slot.active && slot.effect.duration != 0 && now - slot.start >= slot.effect.duration)
+      slot.active = false;
+  }
+
+  for (uint16_t i = 0; i < count; i++)
+    frame[i] = 0;
+
+  for (uint8_t type = 0; type < EFFECT_TYPES; type++) {
+    for (const Slot &slot : _slots) {
+      if (!slot.active || slot.effect.type != type)
+        continue;
+
+      switch (type) {
+        case EFFECT_BASE:
+          for (uint16_t i = 0; i < lit; i++)
+            frame[i] = slot.effect.color;
+          break;
+        case EFFECT_FLICKER:
+          drawFlicker(slot, frame, lit, level);
+          break;
+        case EFFECT_LOCKUP:
+          drawSpot(slot, frame, lit, 96 + (noise() & 0x9f));
+          break;
+        case EFFECT_BLASTER:
+          drawSpot(slot, frame, lit, fade(slot, now));
+          break;
+        case EFFECT_CLASH: {
+          uint16_t alpha = fade(slot, now);
+          for (uint16_t i = 0; i < lit; i++)
+            frame[i] = blendColor(frame[i], slot.effect.color, alpha);
+          break;
+        }
+      }
+    }
+  }
+}
+
+
+void EffectEngine::drawFlicker(const Slot &slot, uint32_t *frame, uint16_t lit, uint16_t level) {
+  if (level > FLICKER_FULL)
+    level = FLICKER_FULL;
+  uint32_t scale = FLICKER_BASE + (uint32_t)level * FLICKER_DEPTH / FLICKER_FULL;
+
+  if (slot.effect.noise == 0) {
+    for (uint16_t i = 0; i < lit; i++)
+      frame[i] = scaleColor(frame[i], scale);
+    return;
+  }
+
+  // every pixel loses up to noise/256 of its brightness at random
+  uint32_t depth = scale * slot.effect.noise;
+  for (uint16_t i = 0; i < lit; i++)
+    frame[i] = scaleColor(frame[i], scale - (depth * (noise() & 0xff) >> 16));
+}
+
+
+void EffectEngine::drawSpot(const Slot &slot, uint32_t *frame, uint16_t lit, uint16_t alpha) {
+  int32_t position = slot.effect.position;
+  int32_t width = slot.effect.width + 1;
+  int32_t first = position - width + 1;
+  int32_t end = position + width;
+
+  if (first < 0)
+    first = 0;
+  if (end > lit)
+    end = lit;
+
+  // alpha falls off linearly to the edges of the spot
+  for (int32_t i = first; i < end; i++) {
+    int32_t distance = i > position ? i - position : position - i;
+    frame[i] = blendColor(frame[i], slot.effect.color, alpha * (width - distance) / width);
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef EffectEngine_h
+#define EffectEngine_h
+
+#include <stdint.h>
+
+#define EFFECT_MAX 8           // effect instances in the pool
+
+// The flicker follows the audio level: the base brightness is
+// FLICKER_BASE / 256, a level of FLICKER_FULL or more adds FLICKER_DEPTH.
+#define FLICKER_BASE  160
+#define FLICKER_DEPTH 96
+#define FLICKER_FULL  4096     // Q15, a loud hum
+
+// effect types, also the order the layers are drawn in
+enum EffectType : uint8_t {
+  EFFECT_BASE,       // blade color over the lit part
+  EFFECT_FLICKER,    // brightness from the audio level, noise per pixel
+  EFFECT_LOCKUP,     // random flashes around position until stopped
+  EFFECT_BLASTER,    // spot at position fading out
+  EFFECT_CLASH,      // whole blade flash fading out
+  EFFECT_TYPES
+};
+
+struct Effect {
+  uint8_t type;
+  uint32_t color;      // 0x00RRGGBB, unused by the flicker
+  uint16_t duration;   // ms, 0 runs until stopped
+  uint16_t position;   // pixel, blaster and lockup center
+  uint16_t width;      // pixels either side of position
+  uint8_t noise;       // flicker: random depth per pixel, 0..255
+};
+
+//
+// Composes the blade from layers of effects.
+//
+// Effects are started into a fixed pool, nothing is allocated at runtime.
+// Every frame the layers are drawn in EffectType order into the frame:
+// the base fills the lit part, the flicker scales it, the others are
+// mixed on top with an 8 bit alpha. Effects with a duration fade out and
+// free their slot by themselves.
+//
+class EffectEngine {
+  public:
+    // returns the slot or -1 if the pool is full
+    int start(const Effect &effect, uint32_t now);
+    void stop(int slot);
+    void stopAll(uint8_t type);
+    bool active(uint8_t type) const;
+    uint8_t activeCount() const;
+
+    // draw all layers, lit is the number of pixels from the hilt that are
+    // on, level the audio envelope (Q15)
+    void render(uint32_t now, uint32_t *frame, uint16_t count, uint16_t lit, uint16_t level);
+
+  private:
+    struct Slot {
+      Effect effect;
+      uint32_t start;
+      bool active;
+    };
+
+    // 256 at the start of the effect down to 0 at its end
+    uint16_t fade(const Slot &slot, uint32_t now) const;
+    uint32_t noise();
+
+    void drawFlicker(const Slot &slot, uint32_t *frame, uint16_t lit, uint16_t level);
+    void drawSpot(const Slot &slot, uint32_t *frame, uint16_t lit, uint16_t alpha);
+
+    Slot _slots[EFFECT_MAX] = {};
+    uint32_t _seed = 2463534242u;
+};
+
+#endif
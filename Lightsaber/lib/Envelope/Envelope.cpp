@@ -0,0 +1,29 @@
+#include "Envelope.h"
+#include "FixedMath.h"
+
+
+void Envelope::process(const int32_t *block, size_t count) {
+  if (count == 0)
+    return;
+
+  // 12 bit squares are up to 2^22, 32 bits would only hold 1023 of them
+  uint64_t sum = 0;
+  int32_t peak = 0;
+  for (size_t i = 0; i < count; i++) {
+    int32_t s = block[i] >> 20;
+    sum += (uint32_t)(s * s);
+    if (s < 0)
+      s = -s;
+    if (s > peak)
+      peak = s;
+  }
+
+  int32_t rms = isqrt32((uint32_t)(sum / count)) << 4;   // 0..2048 -> Q15
+  if (rms > ENVELOPE_ONE)
+    rms = ENVELOPE_ONE;
+  int32_t rate = rms > _smooth ? _attack : _release;
+  _smooth += ((rms - _smooth) * rate) >> 15;
+
+  _level.store((uint16_t)_smooth, std::memory_order_relaxed);
+  _peak.store((uint16_t)(peak >= 2048 ? ENVELOPE_ONE : peak << 4), std::memory_order_relaxed);
+}
@@ -0,0 +1,39 @@
+#ifndef Envelope_h
+#define Envelope_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define ENVELOPE_ONE 32767   // full scale level (Q15)
+
+//
+// Envelope follower for the mixed audio.
+//
+// process() is called by the audio task on each block right after it was
+// mixed, it only reads the block in place. Per block it measures RMS and
+// peak with integer math and smooths the RMS with separate attack and
+// release rates. level() and peak() can be read from any task.
+//
+class Envelope {
+  public:
+    // attack / release: Q15 fraction of the distance covered per block
+    Envelope(uint16_t attack = 16384, uint16_t release = 2048)
+      : _attack(attack), _release(release) {}
+
+    // block of 32 bit I2S samples as produced by the Mixer
+    void process(const int32_t *block, size_t count);
+
+    // smoothed RMS level and last block peak, Q15
+    uint16_t level() const { return _level.load(std::memory_order_relaxed); }
+    uint16_t peak() const { return _peak.load(std::memory_order_relaxed); }
+
+  private:
+    uint16_t _attack;
+    uint16_t _release;
+    int32_t _smooth = 0;
+    std::atomic<uint16_t> _level{0};
+    std::atomic<uint16_t> _peak{0};
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <esp_partition.h>
+
+#include "AudioTools.h"
+#include "EspHal.h"
+
+
+uint32_t ArduinoClock::millis() {
+  return ::millis();
+}
+
+uint32_t ArduinoClock::micros() {
+  return ::micros();
+}
+
+
+int32_t EspFileSystem::read(const char *path, char *buf, size_t size) {
+  if (!_mounted && !(_mounted = SPIFFS.begin()))
+    return -1;
+  File file = SPIFFS.open(path, "r");
+  if (!file)
+    return -1;
+
+  int32_t length = file.size() <= size ? file.read((uint8_t *)buf, file.size()) : -1;
+  file.close();
+  return length;
+}
+
+
+// the mapping stays for the lifetime of the firmware
+const uint8_t *EspFileSystem::map(const char *partition, size_t &size) {
+  const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                  ESP_PARTITION_SUBTYPE_ANY, partition);
+  const void *image;
+  spi_flash_mmap_handle_t handle;
+
+  if (part == nullptr ||
+      esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &image, &handle) != ESP_OK)
+    return nullptr;
+  size = part->size;
+  return (const uint8_t *)image;
+}
+
+
+static I2SStream i2s;      // the one I2S port, keeps AudioTools out of the header
+
+bool I2sSink::begin(uint32_t sampleRate) {
+  auto config = i2s.defaultConfig(TX_MODE);
+  config.pin_ws = _pinWs;
+  config.pin_bck = _pinBck;
+  config.pin_data = _pinData;
+  config.sample_rate = sampleRate;
+  config.bits_per_sample = 32;
+  config.channels = 1;
+  return i2s.begin(config);
+}
+
+// blocks until DMA has room
+size_t I2sSink::write(const int32_t *samples, size_t count) {
+  return i2s.write((const uint8_t *)samples, count * sizeof(int32_t)) / sizeof(int32_t);
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef EspHal_h
+#define EspHal_h
+
+#include "Hal.h"
+
+//
+// ESP32 side of the HAL. The button (ButtonInput), the strips (RmtStrip)
+// and the IMU (Mpu6050) implement their interfaces themselves.
+//
+
+class ArduinoClock : public Clock {
+  public:
+    uint32_t millis() override;
+    uint32_t micros() override;
+};
+
+
+// files on SPIFFS, mounted on first use, partitions memory mapped
+class EspFileSystem : public FileSystem {
+  public:
+    int32_t read(const char *path, char *buf, size_t size) override;
+    const uint8_t *map(const char *partition, size_t &size) override;
+
+  private:
+    bool _mounted = false;
+};
+
+
+// mono 32 bit samples to the I2S DAC
+class I2sSink : public AudioSink {
+  public:
+    I2sSink(int pinWs, int pinBck, int pinData) : _pinWs(pinWs), _pinBck(pinBck), _pinData(pinData) {}
+
+    bool begin(uint32_t sampleRate) override;
+    size_t write(const int32_t *samples, size_t count) override;
+
+  private:
+    int _pinWs;
+    int _pinBck;
+    int _pinData;
+};
+
+#endif
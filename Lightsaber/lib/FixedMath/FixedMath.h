@@ -0,0 +1,32 @@
+#ifndef FixedMath_h
+#define FixedMath_h
+
+#include <stdint.h>
+
+// integer square root, exact floor for any 32 bit value
+inline uint32_t isqrt32(uint32_t v) {
+  uint32_t root = 0;
+  uint32_t bit = 1u << 30;
+  while (bit > v)
+    bit >>= 2;
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// square root for tables computed by the compiler, Newton from above
+constexpr double constexprSqrt(double x) {
+  double r = x > 1 ? x : 1;
+  for (int i = 0; i < 32; i++)
+    r = 0.5 * (r + x / r);
+  return r;
+}
+
+#endif
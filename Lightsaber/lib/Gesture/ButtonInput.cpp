@@ -0,0 +1,22 @@
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "ButtonInput.h"
+
+
+void ButtonInput::begin() {
+  pinMode(_pin, _activeLow ? INPUT_PULLUP : INPUT);
+  attachInterruptArg(digitalPinToInterrupt(_pin), isr, this, CHANGE);
+}
+
+
+void IRAM_ATTR ButtonInput::isr(void *arg) {
+  ButtonInput *self = (ButtonInput *)arg;
+  bool pressed = (digitalRead(self->_pin) == HIGH) != self->_activeLow;
+
+  if (!self->_edges.push({ (uint32_t)millis(), pressed }))
+    self->_dropped = self->_dropped + 1;
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef ButtonInput_h
+#define ButtonInput_h
+
+#include <stdint.h>
+
+#include "ButtonSource.h"
+#include "SpscRing.h"
+
+#define BUTTON_EDGES 32    // raw edges queued between the interrupt and the reader
+
+//
+// Interrupt driven button input.
+//
+// A GPIO interrupt on both edges timestamps every level change into a
+// lock-free queue, nothing is lost while loop() is busy. The reader pops
+// the raw edges and feeds them into a GestureRecognizer, which also does the
+// debouncing.
+//
+class ButtonInput : public ButtonSource {
+  public:
+    // activeLow: the button pulls the pin to ground, the internal pull-up is used
+    ButtonInput(uint8_t pin, bool activeLow = true) : _pin(pin), _activeLow(activeLow) {}
+
+    void begin() override;
+
+    // reader side
+    bool pop(ButtonEdge &edge) override { return _edges.pop(edge); }
+    uint32_t dropped() const { return _dropped; }
+
+  private:
+    static void isr(void *arg);
+
+    uint8_t _pin;
+    bool _activeLow;
+    SpscRing<ButtonEdge, BUTTON_EDGES> _edges;
+    volatile uint32_t _dropped = 0;
+};
+
+#endif
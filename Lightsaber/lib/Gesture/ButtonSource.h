@@ -0,0 +1,19 @@
+#ifndef ButtonSource_h
+#define ButtonSource_h
+
+#include "GestureRecognizer.h"
+
+//
+// Timestamped button edges, decoded by a GestureRecognizer.
+//
+// Header only and apart from Hal.h, so sketches that only want the button
+// (ButtonInput) do not pull in the HAL implementations.
+//
+class ButtonSource {
+  public:
+    virtual ~ButtonSource() {}
+    virtual void begin() = 0;
+    virtual bool pop(ButtonEdge &edge) = 0;
+};
+
+#endif
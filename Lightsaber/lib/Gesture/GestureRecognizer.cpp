@@ -0,0 +1,100 @@
+#include "GestureRecognizer.h"
+
+
+void GestureRecognizer::edge(const ButtonEdge &edge) {
+  update(edge.time);
+
+  _raw = edge.pressed;
+  _rawTime = edge.time;
+  if (edge.pressed == _pressed) {
+    _bouncing = false;
+    return;
+  }
+  if (edge.time - _lastEdge < _config.debounce) {
+    _bouncing = true;
+    return;
+  }
+  accept(edge.time, edge.pressed);
+}
+
+
+void GestureRecognizer::update(uint32_t now) {
+  // a bounce left the button at a new level, take it once it is stable
+  if (_bouncing && now - _rawTime >= _config.debounce) {
+    _bouncing = false;
+    accept(_rawTime, _raw);
+  }
+
+  switch (_state) {
+    case PRESSED:
+      if (now - _pressTime >= _config.hold) {
+        emit(GESTURE_HOLD, _pressTime + _config.hold);
+        _state = HELD;
+      }
+      break;
+    case PRESSED2:
+      if (now - _pressTime >= _config.hold) {
+        emit(GESTURE_HOLD_CLICK, _pressTime + _config.hold);
+        _state = HELD;
+      }
+      break;
+    case CLICKED:
+      if (now - _releaseTime > _config.doubleGap) {
+        emit(GESTURE_CLICK, _releaseTime + _config.doubleGap);
+        _state = IDLE;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+
+void GestureRecognizer::accept(uint32_t time, bool pressed) {
+  // timeouts up to this edge first, a late hold must not become a click
+  _pressed = pressed;
+  _lastEdge = time;
+  update(time);
+
+  if (pressed) {
+    _state = _state == CLICKED ? PRESSED2 : PRESSED;
+    _pressTime = time;
+    return;
+  }
+
+  // a press shorter than the debounce time is a glitch, not a click
+  uint32_t length = time - _pressTime;
+  bool glitch = length < _config.debounce;
+  bool click = !glitch && length < _config.clickMax;
+  switch (_state) {
+    case PRESSED:
+      _state = click ? CLICKED : IDLE;
+      _releaseTime = time;
+      break;
+    case PRESSED2:
+      if (click)
+        emit(GESTURE_DOUBLE_CLICK, time);
+      _state = glitch ? CLICKED : IDLE;
+      break;
+    default:
+      _state = IDLE;
+      break;
+  }
+}
+
+
+void GestureRecognizer::emit(uint8_t type, uint32_t time) {
+  if (_outCount == GESTURE_QUEUE)
+    return;     // nobody pops, drop
+  _out[(_outHead + _outCount++) % GESTURE_QUEUE] = { type, time };
+}
+
+
+bool GestureRecognizer::pop(Gesture &gesture) {
+  if (_outCount == 0)
+    return false;
+  gesture = _out[_outHead];
+  _outHead = (_outHead + 1) % GESTURE_QUEUE;
+  _outCount--;
+  return true;
+}
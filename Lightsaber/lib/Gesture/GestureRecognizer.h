@@ -0,0 +1,87 @@
+#ifndef GestureRecognizer_h
+#define GestureRecognizer_h
+
+#include <stdint.h>
+
+#define GESTURE_QUEUE 4    // gestures kept until pop()
+
+// one debounced or raw level change of the button
+struct ButtonEdge {
+  uint32_t time;        // ms
+  bool pressed;
+};
+
+enum GestureType {
+  GESTURE_CLICK,
+  GESTURE_DOUBLE_CLICK,
+  GESTURE_HOLD,
+  GESTURE_HOLD_CLICK    // click, then press and hold: hold-and-click on a single button
+};
+
+struct Gesture {
+  uint8_t type;
+  uint32_t time;        // ms, when the gesture was complete
+};
+
+//
+// Decodes button gestures from timestamped edges, pure logic.
+//
+// Decisions are made on the edge timestamps only, so a late caller sees the
+// same gestures as a prompt one. Feed edges in order with edge(), call
+// update() with the current time to let timeouts expire, then pop() the
+// gestures.
+//
+// A press shorter than clickMax is a click. A click is reported once no
+// second press follows within doubleGap; a second short press makes it a
+// double click. A press held for hold is a hold, reported while the button
+// is still down; after a click it is a hold-click instead. Edges closer than
+// debounce to the last accepted edge are bounces, the level they leave
+// behind is taken once it was stable for debounce. Presses shorter than
+// debounce are glitches and ignored.
+//
+class GestureRecognizer {
+  public:
+    struct Config {
+      uint16_t debounce = 20;     // ms
+      uint16_t clickMax = 350;    // ms, longest press that still counts as a click
+      uint16_t doubleGap = 250;   // ms, longest release between the clicks of a double click
+      uint16_t hold = 800;        // ms
+    };
+
+    GestureRecognizer() {}
+    GestureRecognizer(const Config &config) : _config(config) {}
+
+    void edge(const ButtonEdge &edge);
+    void update(uint32_t now);
+    bool pop(Gesture &gesture);
+
+    bool pressed() const { return _pressed; }
+
+  private:
+    enum State : uint8_t {
+      IDLE,
+      PRESSED,      // first press
+      CLICKED,      // released after a click, waiting for a second press
+      PRESSED2,     // second press after a click
+      HELD          // hold reported, waiting for the release
+    };
+
+    void accept(uint32_t time, bool pressed);
+    void emit(uint8_t type, uint32_t time);
+
+    Config _config;
+    State _state = IDLE;
+    bool _pressed = false;        // debounced level
+    uint32_t _lastEdge = 0;       // time of the last accepted edge
+    bool _bouncing = false;       // a raw edge was dropped as bounce
+    bool _raw = false;            // level after the last raw edge
+    uint32_t _rawTime = 0;
+    uint32_t _pressTime = 0;
+    uint32_t _releaseTime = 0;
+
+    Gesture _out[GESTURE_QUEUE];
+    uint8_t _outHead = 0;
+    uint8_t _outCount = 0;
+};
+
+#endif
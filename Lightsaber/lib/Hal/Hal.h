@@ -0,0 +1,54 @@
+#ifndef Hal_h
+#define Hal_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "StripDriver.h"
+#include "ButtonSource.h"
+
+//
+// Hardware seen by the saber logic.
+//
+// Saber only talks to these interfaces, so the same firmware loop runs on
+// the ESP32 (EspHal.h) and on Linux (NativeHal.h), where the clock is
+// virtual and the whole loop runs faster than real time. The IMU has its
+// interface in MotionSensor.h, the button in ButtonSource.h.
+//
+
+class Clock {
+  public:
+    virtual ~Clock() {}
+    virtual uint32_t millis() = 0;
+    virtual uint32_t micros() = 0;
+};
+
+
+class FileSystem {
+  public:
+    virtual ~FileSystem() {}
+    // whole file into buf, returns its length, -1 if missing or larger than size
+    virtual int32_t read(const char *path, char *buf, size_t size) = 0;
+    // read only view of a data partition (on the host the file
+    // <partition>.bin), nullptr if there is none
+    virtual const uint8_t *map(const char *partition, size_t &size) = 0;
+};
+
+
+// mono 32 bit I2S samples
+class AudioSink {
+  public:
+    virtual ~AudioSink() {}
+    virtual bool begin(uint32_t sampleRate) = 0;
+    // blocks until the samples are taken, returns the samples written
+    virtual size_t write(const int32_t *samples, size_t count) = 0;
+};
+
+
+// one WS2812 strip, pin and length come from the config
+class LedStrip : public StripDriver {
+  public:
+    virtual bool begin(int pin, uint16_t numPixels) = 0;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef ARDUINO
+
+#include <string.h>
+
+#include "NativeHal.h"
+
+
+bool DirFileSystem::load(const std::string &path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == nullptr)
+    return false;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+
+int32_t DirFileSystem::read(const char *path, char *buf, size_t size) {
+  std::vector<uint8_t> data;
+  if (!load(_root + "/" + path, data) || data.size() > size)
+    return -1;
+  memcpy(buf, data.data(), data.size());
+  return (int32_t)data.size();
+}
+
+
+// loaded once, the image stays valid for the lifetime of the file system
+const uint8_t *DirFileSystem::map(const char *partition, size_t &size) {
+  auto it = _images.find(partition);
+  if (it == _images.end()) {
+    std::vector<uint8_t> data;
+    if (!load(_root + "/" + partition + ".bin", data))
+      return nullptr;
+    it = _images.emplace(partition, std::move(data)).first;
+  }
+  size = it->second.size();
+  return it->second.data();
+}
+
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+static void wavHeader(uint8_t *h, uint32_t sampleRate, uint32_t samples) {
+  uint32_t bytes = samples * 2;
+  memcpy(h, "RIFF", 4);
+  put32(h + 4, 36 + bytes);
+  memcpy(h + 8, "WAVEfmt ", 8);
+  put32(h + 16, 16);
+  put16(h + 20, 1);                  // PCM
+  put16(h + 22, 1);                  // mono
+  put32(h + 24, sampleRate);
+  put32(h + 28, sampleRate * 2);
+  put16(h + 32, 2);
+  put16(h + 34, 16);
+  memcpy(h + 36, "data", 4);
+  put32(h + 40, bytes);
+}
+
+
+bool WavSink::begin(uint32_t sampleRate) {
+  _sampleRate = sampleRate;
+  if (_path == nullptr)
+    return true;
+  _file = fopen(_path, "wb");
+  if (_file == nullptr)
+    return false;
+  uint8_t header[44];
+  wavHeader(header, sampleRate, 0);
+  return fwrite(header, sizeof(header), 1, _file) == 1;
+}
+
+
+// I2S samples carry the audio in the upper 16 bits
+size_t WavSink::write(const int32_t *samples, size_t count) {
+  _samples += count;
+  if (_file == nullptr)
+    return count;
+  int16_t pcm[256];
+  for (size_t done = 0; done < count; ) {
+    size_t n = count - done < 256 ? count - done : 256;
+    for (size_t i = 0; i < n; i++) {
+      int32_t s = samples[done + i] >> 16;
+      pcm[i] = (int16_t)(s > 32767 ? 32767 : s < -32768 ? -32768 : s);
+    }
+    fwrite(pcm, sizeof(int16_t), n, _file);
+    done += n;
+  }
+  return count;
+}
+
+
+void WavSink::close() {
+  if (_file == nullptr)
+    return;
+  uint8_t header[44];
+  wavHeader(header, _sampleRate, (uint32_t)_samples);
+  fseek(_file, 0, SEEK_SET);
+  fwrite(header, sizeof(header), 1, _file);
+  fclose(_file);
+  _file = nullptr;
+}
+
+
+bool MemoryStrip::begin(int pin, uint16_t numPixels) {
+  _pin = pin;
+  _frame.assign(numPixels, 0);
+  return true;
+}
+
+
+void MemoryStrip::show(const uint32_t *frame, uint16_t count) {
+  _frame.assign(frame, frame + count);
+  _frames++;
+}
+
+
+bool ScriptedButton::pop(ButtonEdge &edge) {
+  if (_next == _edges.size() || _edges[_next].time > _clock.millis())
+    return false;
+  edge = _edges[_next++];
+  return true;
+}
+
+
+void ScriptedButton::press(uint32_t time, uint32_t duration) {
+  _edges.push_back({ time, true });
+  _edges.push_back({ time + duration, false });
+}
+
+#endif
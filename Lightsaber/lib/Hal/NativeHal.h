@@ -0,0 +1,104 @@
+#ifndef NativeHal_h
+#define NativeHal_h
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Hal.h"
+
+//
+// Linux side of the HAL, for running the saber on the host.
+//
+// Time is virtual and only moves when the simulation advances it, so a
+// run is deterministic and as fast as the host can compute it.
+//
+
+class VirtualClock : public Clock {
+  public:
+    uint32_t millis() override { return (uint32_t)(_micros / 1000); }
+    uint32_t micros() override { return (uint32_t)_micros; }
+
+    void advance(uint32_t micros) { _micros += micros; }
+    uint64_t now() const { return _micros; }
+
+  private:
+    uint64_t _micros = 0;
+};
+
+
+// files below a root directory (data/), partitions are <root>/<name>.bin
+class DirFileSystem : public FileSystem {
+  public:
+    DirFileSystem(const char *root) : _root(root) {}
+
+    int32_t read(const char *path, char *buf, size_t size) override;
+    const uint8_t *map(const char *partition, size_t &size) override;
+
+  private:
+    bool load(const std::string &path, std::vector<uint8_t> &data);
+
+    std::string _root;
+    std::map<std::string, std::vector<uint8_t>> _images;
+};
+
+
+// writes the audio into a 16 bit mono wav file, or just counts it
+class WavSink : public AudioSink {
+  public:
+    // path nullptr discards the samples
+    WavSink(const char *path = nullptr) : _path(path) {}
+    ~WavSink() { close(); }
+
+    bool begin(uint32_t sampleRate) override;
+    size_t write(const int32_t *samples, size_t count) override;
+    // patch the header, done by the destructor as well
+    void close();
+
+    uint64_t samples() const { return _samples; }
+
+  private:
+    const char *_path;
+    FILE *_file = nullptr;
+    uint32_t _sampleRate = 0;
+    uint64_t _samples = 0;
+};
+
+
+// keeps the last frame in memory
+class MemoryStrip : public LedStrip {
+  public:
+    bool begin(int pin, uint16_t numPixels) override;
+    void show(const uint32_t *frame, uint16_t count) override;
+
+    int pin() const { return _pin; }
+    const std::vector<uint32_t> &frame() const { return _frame; }
+    uint32_t frames() const { return _frames; }
+
+  private:
+    int _pin = -1;
+    std::vector<uint32_t> _frame;
+    uint32_t _frames = 0;
+};
+
+
+// button edges from a script, handed out once the clock passes them
+class ScriptedButton : public ButtonSource {
+  public:
+    ScriptedButton(Clock &clock) : _clock(clock) {}
+
+    void begin() override {}
+    bool pop(ButtonEdge &edge) override;
+
+    // press at time for duration ms, presses must come in time order
+    void press(uint32_t time, uint32_t duration);
+    bool done() const { return _next == _edges.size(); }
+
+  private:
+    Clock &_clock;
+    std::vector<ButtonEdge> _edges;
+    size_t _next = 0;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "HumLoop.h"
+
+
+bool HumLoop::begin(PcmSource &source, uint16_t crossfade) {
+  _source = &source;
+  _length = source.length();
+
+  if (crossfade > HUM_XFADE_MAX)
+    crossfade = HUM_XFADE_MAX;
+  if (crossfade > _length / 4)
+    crossfade = _length / 4;
+  _crossfade = crossfade;
+
+  // keep the head resident, the source is now positioned right after it
+  if (_length == 0 || !source.seek(0) || source.read(_head, _crossfade) != _crossfade) {
+    _source = nullptr;
+    return false;
+  }
+  _position = 0;
+  return true;
+}
+
+
+bool HumLoop::seek(uint32_t sample) {
+  if (_source == nullptr)
+    return false;
+  sample %= length();
+  _position = sample;
+  if (sample < _crossfade)
+    return _source->seek(_crossfade);
+  return _source->seek(sample);
+}
+
+
+size_t HumLoop::read(int16_t *data, size_t count) {
+  if (_source == nullptr)
+    return 0;
+
+  uint32_t fadeStart = _length - _crossfade;
+  size_t done = 0;
+
+  while (done < count) {
+    size_t n = count - done;
+
+    if (_position < _crossfade) {
+      // head, served from RAM
+      if (n > _crossfade - _position)
+        n = _crossfade - _position;
+      for (size_t i = 0; i < n; i++)
+        data[done + i] = _head[_position + i];
+    } else if (_position < fadeStart) {
+      // body, straight from the source
+      if (n > fadeStart - _position)
+        n = fadeStart - _position;
+      n = _source->read(data + done, n);
+      if (n == 0)
+        break;
+    } else {
+      // tail, fade out the tail while fading in the head
+      uint32_t k = _position - fadeStart;
+      if (n > _crossfade - k)
+        n = _crossfade - k;
+      n = _source->read(data + done, n);
+      if (n == 0)
+        break;
+      for (size_t i = 0; i < n; i++, k++) {
+        int32_t in = ((k + 1) << 15) / (_crossfade + 1);    // Q15 fade in weight
+        int32_t mixed = (data[done + i] * (32768 - in) + _head[k] * in) >> 15;
+        data[done + i] = (int16_t)mixed;
+      }
+    }
+
+    done += n;
+    _position += n;
+
+    if (_position == _length) {
+      // wrapped, the head has just been played as part of the fade
+      _position = _crossfade;
+      if (!_source->seek(_crossfade))
+        break;
+    }
+  }
+  return done;
+}
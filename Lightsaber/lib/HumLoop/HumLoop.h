@@ -0,0 +1,36 @@
+#ifndef HumLoop_h
+#define HumLoop_h
+
+#include "PcmSource.h"
+
+#define HUM_XFADE_MAX 1024   // longest supported crossfade in samples
+
+//
+// Endless, gapless loop over a PcmSource.
+//
+// The first 'crossfade' samples of the source are kept in RAM. When playback
+// reaches the last 'crossfade' samples, the tail is faded out while the
+// resident head is faded in, and playback then continues right after the
+// head. The source is therefore only seeked once per loop and the header is
+// never parsed again, there is no gap and no click at the loop point.
+//
+class HumLoop : public PcmSource {
+  public:
+    // crossfade is clamped to HUM_XFADE_MAX and to a quarter of the source
+    bool begin(PcmSource &source, uint16_t crossfade);
+
+    // never runs dry, returns less than count only if the source fails
+    size_t read(int16_t *data, size_t count) override;
+    bool seek(uint32_t sample) override;
+    // length of one loop period
+    uint32_t length() const override { return _length - _crossfade; }
+
+  private:
+    PcmSource *_source = nullptr;
+    int16_t _head[HUM_XFADE_MAX];
+    uint32_t _length = 0;
+    uint32_t _position = 0;   // position in the source
+    uint16_t _crossfade = 0;
+};
+
+#endif
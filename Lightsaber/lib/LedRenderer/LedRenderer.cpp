@@ -0,0 +1,86 @@
+#include "LedRenderer.h"
+
+
+LedRenderer::LedRenderer(StripDriver &driver, uint16_t numPixels, uint16_t maxFps)
+  : _driver(driver), _numPixels(numPixels > LED_MAX_PIXELS ? LED_MAX_PIXELS : numPixels) {
+  setMaxFps(maxFps);
+  for (uint16_t i = 0; i < LED_MAX_PIXELS; i++)
+    _frame[i] = 0;
+}
+
+
+void LedRenderer::setMaxFps(uint16_t maxFps) {
+  _interval = maxFps ? 1000000 / maxFps : 0;
+}
+
+
+void LedRenderer::setNumPixels(uint16_t numPixels) {
+  _numPixels = numPixels > LED_MAX_PIXELS ? LED_MAX_PIXELS : numPixels;
+  touch();
+}
+
+
+void LedRenderer::setBrightness(uint8_t brightness) {
+  if (brightness != _lut.brightness()) {
+    _lut.setBrightness(brightness);
+    touch();
+  }
+}
+
+
+void LedRenderer::set(uint16_t pixel, uint32_t color) {
+  if (pixel < _numPixels && _frame[pixel] != color) {
+    _frame[pixel] = color;
+    touch();
+  }
+}
+
+
+void LedRenderer::fill(uint32_t color, uint16_t first, uint16_t count) {
+  uint32_t end = (uint32_t)first + count;
+  if (end > _numPixels)
+    end = _numPixels;
+  for (uint32_t i = first; i < end; i++)
+    set(i, color);
+}
+
+
+void LedRenderer::write(const uint32_t *frame, uint16_t count) {
+  if (count > _numPixels)
+    count = _numPixels;
+  for (uint16_t i = 0; i < count; i++)
+    set(i, frame[i]);
+}
+
+
+bool LedRenderer::render(uint32_t nowMicros) {
+  if (!_dirty)
+    return false;
+  if (!due(nowMicros)) {
+    _held = true;
+    return false;
+  }
+
+  // gamma and brightness, summing the channels for the current estimate,
+  // then scale the same frame down if it is over budget
+  uint32_t sum = 0;
+  for (uint16_t i = 0; i < _numPixels; i++) {
+    uint32_t c = _lut.map(_frame[i]);
+    _out[i] = c;
+    sum += (c & 0xff) + (c >> 8 & 0xff) + (c >> 16);
+  }
+  uint16_t scale = _limiter.update(sum, _numPixels);
+  if (scale < POWER_SCALE_ONE) {
+    for (uint16_t i = 0; i < _numPixels; i++)
+      _out[i] = scaleColor(_out[i], scale);
+  }
+  _driver.show(_out, _numPixels);
+
+  _lastFrame = nowMicros;
+  // keep sending while the limiter ramps back up
+  _dirty = _limiter.rising();
+  _first = false;
+  _held = false;
+  _rendered++;
+  return true;
+}
@@ -0,0 +1,87 @@
+#ifndef LedRenderer_h
+#define LedRenderer_h
+
+#include "StripDriver.h"
+#include "PowerLimiter.h"
+
+#define LED_MAX_PIXELS 300
+
+//
+// Frame buffer in front of a StripDriver.
+//
+// Effects write pixels into the frame buffer, render() only pushes the frame
+// to the strip if a pixel actually changed and at most maxFps times per
+// second. Every strip update costs interrupt-free time, so redundant frames
+// are simply never sent.
+//
+// The frame buffer holds linear full scale colors. Gamma and brightness are
+// applied by a ColorLut in one pass into the output buffer when a frame is
+// sent. The same pass sums the channels for the PowerLimiter, a frame over
+// the budget is scaled down before it goes to the strip.
+//
+class LedRenderer {
+  public:
+    LedRenderer(StripDriver &driver, uint16_t numPixels, uint16_t maxFps = 100);
+
+    void setMaxFps(uint16_t maxFps);
+    // 0..255, takes effect with the next frame
+    void setBrightness(uint8_t brightness);
+    uint8_t brightness() const { return _lut.brightness(); }
+    // strip current budget in mA (0 = unlimited), copies as in PowerLimiter,
+    // takes effect with the next frame
+    void setPowerBudget(uint16_t budgetMa, uint8_t copies = 1) {
+      _limiter.begin(budgetMa, copies);
+      touch();
+    }
+    const PowerLimiter &limiter() const { return _limiter; }
+    // frame length, clamped to LED_MAX_PIXELS
+    void setNumPixels(uint16_t numPixels);
+    uint16_t numPixels() const { return _numPixels; }
+
+    // frame buffer access, colors are 0x00RRGGBB
+    void set(uint16_t pixel, uint32_t color);
+    void fill(uint32_t color, uint16_t first = 0, uint16_t count = LED_MAX_PIXELS);
+    void clear() { fill(0); }
+    // copy a whole frame, e.g. from the effect engine
+    void write(const uint32_t *frame, uint16_t count);
+    uint32_t get(uint16_t pixel) const { return pixel < _numPixels ? _frame[pixel] : 0; }
+    bool dirty() const { return _dirty; }
+
+    // true once the frame interval is over, compose the next frame only then
+    bool due(uint32_t nowMicros) const { return _first || nowMicros - _lastFrame >= _interval; }
+
+    // push the frame if it changed and the frame interval is over,
+    // returns true if a frame was sent
+    bool render(uint32_t nowMicros);
+
+    // frames sent / frames held back by the frame interval and changed again
+    // before they were ever sent
+    uint32_t framesRendered() const { return _rendered; }
+    uint32_t framesSkipped() const { return _skipped; }
+
+  private:
+    // the frame changed, a held back frame is now replaced
+    void touch() {
+      if (_held) {
+        _held = false;
+        _skipped++;
+      }
+      _dirty = true;
+    }
+
+    StripDriver &_driver;
+    uint32_t _frame[LED_MAX_PIXELS];
+    uint32_t _out[LED_MAX_PIXELS];  // gamma corrected frame for the driver
+    ColorLut _lut;
+    PowerLimiter _limiter;
+    uint16_t _numPixels;
+    uint32_t _interval = 0;         // minimum micros between frames
+    uint32_t _lastFrame = 0;
+    bool _dirty = true;             // send the first frame in any case
+    bool _first = true;
+    bool _held = false;             // dirty frame waiting for the interval
+    uint32_t _rendered = 0;
+    uint32_t _skipped = 0;
+};
+
+#endif
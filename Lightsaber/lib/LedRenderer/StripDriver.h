@@ -0,0 +1,18 @@
+#ifndef StripDriver_h
+#define StripDriver_h
+
+#include <stdint.h>
+
+#include "Color.h"
+
+//
+// Output side of the LED pipeline: pushes one frame of 0x00RRGGBB pixels
+// to the hardware (or to a fake strip on the host).
+//
+class StripDriver {
+  public:
+    virtual ~StripDriver() {}
+    virtual void show(const uint32_t *frame, uint16_t count) = 0;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include <stdio.h>
+
+#include "Log.h"
+
+
+LogBuffer logBuffer;
+
+
+LogBuffer::LogBuffer() : _head(0), _tail(0), _dropped(0) {
+  for (LogRecord &record : _records)
+    record.seq.store(0, std::memory_order_relaxed);
+}
+
+
+bool LogBuffer::record(uint8_t level, uint32_t id, const uint32_t *args, uint8_t argc) {
+  // claim a slot, several producers may race for it
+  uint32_t head = _head.load(std::memory_order_relaxed);
+  do {
+    if (head - _tail.load(std::memory_order_acquire) >= LOG_RECORDS) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  } while (!_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed));
+
+  LogRecord &record = _records[head & (LOG_RECORDS - 1)];
+  record.id = id;
+  record.time = _clock ? _clock() : 0;
+  record.level = level;
+  record.argc = argc;
+  for (uint8_t i = 0; i < argc; i++)
+    record.args[i] = args[i];
+  record.seq.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+
+size_t LogBuffer::drain(Print print, size_t max) {
+  char line[24 + LOG_ARGS * 9];
+  size_t printed = 0;
+  uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+  // stops at the first record still being written, it comes next time
+  while (printed < max) {
+    LogRecord &record = _records[tail & (LOG_RECORDS - 1)];
+    if (record.seq.load(std::memory_order_acquire) != tail + 1)
+      break;
+    int n = snprintf(line, sizeof(line), "log %08x %x %u", record.id, record.time, record.level);
+    for (uint8_t i = 0; i < record.argc && i < LOG_ARGS; i++)
+      n += snprintf(line + n, sizeof(line) - n, " %x", record.args[i]);
+    _tail.store(++tail, std::memory_order_release);
+    print(line);
+    printed++;
+  }
+
+  uint32_t dropped = _dropped.load(std::memory_order_relaxed);
+  if (dropped != _reportedDrops) {
+    snprintf(line, sizeof(line), "log dropped %u", dropped - _reportedDrops);
+    print(line);
+    _reportedDrops = dropped;
+  }
+  return printed;
+}
@@ -0,0 +1,124 @@
+#ifndef Log_h
+#define Log_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO    // calls above this level compile to nothing
+#endif
+#define LOG_RECORDS 64              // deferred records, power of two
+#define LOG_ARGS    4               // numeric arguments per record
+
+// FNV-1a of the format string, the record carries this instead of the text
+constexpr uint32_t logHash(const char *s, uint32_t h = 2166136261u) {
+  return *s ? logHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
+// arguments travel as 32 bits: integers as they are, floats as their bits
+template <typename T>
+inline uint32_t logArg(T value) {
+  static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                "deferred log arguments must be numbers");
+  if constexpr (std::is_floating_point<T>::value) {
+    float f = (float)value;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+  } else {
+    return (uint32_t)value;
+  }
+}
+
+struct LogRecord {
+  std::atomic<uint32_t> seq;      // record number + 1 once complete
+  uint32_t id;
+  uint32_t time;                  // ms
+  uint8_t level;
+  uint8_t argc;
+  uint32_t args[LOG_ARGS];
+};
+
+//
+// Deferred log buffer.
+//
+// LOG_ERROR/WARN/INFO/DEBUG("format", args) store the hash of the format,
+// a timestamp and up to LOG_ARGS numbers in a lock-free ring, from any task
+// on either core. Nothing is formatted and nothing waits for the UART, so
+// logging from the mixer or loop() costs about what a trace event does.
+// Calls above LOG_LEVEL are removed at compile time, arguments included.
+// If the ring is full the record is dropped and counted.
+//
+// A low priority task calls drain(), which prints each record as
+//   log <id> <time> <level> <args>...      (hex)
+// tools/log finds the format strings in the sources and prints the text.
+// Only numbers can be deferred, %s prints as <str>.
+//
+class LogBuffer {
+  public:
+    typedef void (*Print)(const char *line);
+    typedef uint32_t (*Clock)();
+
+    LogBuffer();
+
+    void begin(Clock clock) { _clock = clock; }
+
+    template <typename... Args>
+    bool write(uint8_t level, uint32_t id, Args... args) {
+      static_assert(sizeof...(Args) <= LOG_ARGS, "too many deferred log arguments");
+      const uint32_t values[LOG_ARGS + 1] = { logArg(args)... };
+      return record(level, id, values, sizeof...(Args));
+    }
+    bool record(uint8_t level, uint32_t id, const uint32_t *args, uint8_t argc);
+
+    // consumer side, prints up to max records, returns how many
+    size_t drain(Print print, size_t max = LOG_RECORDS);
+    size_t pending() const { return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_relaxed); }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+  private:
+    LogRecord _records[LOG_RECORDS];
+    std::atomic<uint32_t> _head;
+    std::atomic<uint32_t> _tail;
+    std::atomic<uint32_t> _dropped;
+    uint32_t _reportedDrops = 0;
+    Clock _clock = nullptr;
+};
+
+extern LogBuffer logBuffer;
+
+// forces the hash to compile time
+#define LOG_DEFER(level, format, ...) \
+  logBuffer.write((level), std::integral_constant<uint32_t, logHash(format)>::value, ##__VA_ARGS__)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) LOG_DEFER(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...)  LOG_DEFER(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...)  do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...)  LOG_DEFER(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...)  do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) LOG_DEFER(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Metrics.h"
+
+
+MetricsRegistry metrics;
+
+
+// registration happens at boot, from one task
+int MetricsRegistry::add(const char *name, MetricKind kind) {
+  for (int i = 0; i < _count; i++) {
+    if (strncmp(_names[i], name, METRICS_NAME_LEN - 1) == 0)
+      return i;
+  }
+  if (_count == METRICS_MAX)
+    return METRICS_MAX;
+
+  int id = _count;
+  strncpy(_names[id], name, METRICS_NAME_LEN - 1);
+  _names[id][METRICS_NAME_LEN - 1] = 0;
+  _kinds[id] = kind;
+  _values[id].store(kind == METRIC_MIN ? UINT32_MAX : 0, std::memory_order_relaxed);
+  _count++;
+  return id;
+}
+
+
+void MetricsRegistry::snapshot(MetricsSnapshot &snapshot, uint32_t now) const {
+  snapshot.time = now;
+  snapshot.count = _count;
+  for (int i = 0; i < _count; i++)
+    snapshot.values[i] = get(i);
+}
+
+
+size_t MetricsRegistry::format(const MetricsSnapshot &snapshot, const MetricsSnapshot *previous,
+                               char *buf, size_t size) const {
+  uint32_t elapsed = previous ? snapshot.time - previous->time : 0;
+  size_t n = snprintf(buf, size, "metrics t=%u", snapshot.time);
+
+  for (int i = 0; i < snapshot.count && n < size; i++) {
+    uint32_t value = snapshot.values[i];
+    if (_kinds[i] == METRIC_MIN && value == UINT32_MAX) {
+      n += snprintf(buf + n, size - n, " %s=-", _names[i]);
+      continue;
+    }
+    n += snprintf(buf + n, size - n, " %s=%u", _names[i], value);
+    // counters registered after the previous snapshot have no rate yet
+    if (_kinds[i] == METRIC_COUNTER && elapsed > 0 && i < previous->count && n < size) {
+      uint32_t rate = (uint64_t)(value - previous->values[i]) * 1000 / elapsed;
+      n += snprintf(buf + n, size - n, " %s/s=%u", _names[i], rate);
+    }
+  }
+  return n < size ? n : size - 1;
+}
@@ -0,0 +1,73 @@
+#ifndef Metrics_h
+#define Metrics_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define METRICS_MAX      24
+#define METRICS_NAME_LEN 16
+
+enum MetricKind : uint8_t {
+  METRIC_COUNTER,          // running total, the line shows a rate as well
+  METRIC_GAUGE,            // last value
+  METRIC_MIN,              // low water mark since boot
+};
+
+// values of all metrics at one time, taken without stopping anything
+struct MetricsSnapshot {
+  uint32_t time = 0;       // ms
+  uint8_t count = 0;
+  uint32_t values[METRICS_MAX];
+};
+
+//
+// Fixed-slot counters and gauges for watching the saber in the field.
+//
+// Metrics are registered once by name and updated by id from any task
+// with relaxed atomics, no locks and no allocation. snapshot() copies all
+// slots, format() turns a snapshot into one compact line, counters with
+// their rate since the previous snapshot:
+//   metrics t=12000 loops=1203311 loops/s=100271 pcm=768 ...
+// The values are read one by one, the line is not an atomic cut across
+// metrics. Updates to an id that could not be registered go to a spare
+// slot that is never shown.
+//
+class MetricsRegistry {
+  public:
+    // constant initialized, so globals may register from their constructors
+    constexpr MetricsRegistry() : _values{}, _names{}, _kinds{}, _count(0) {}
+
+    // id of the metric, the existing one if the name is taken, a spare id
+    // if the table is full
+    int add(const char *name, MetricKind kind);
+    uint8_t count() const { return _count; }
+    // id < count()
+    const char *name(int id) const { return _names[id]; }
+    MetricKind kind(int id) const { return _kinds[id]; }
+
+    void inc(int id, uint32_t n = 1) { _values[id].fetch_add(n, std::memory_order_relaxed); }
+    // gauges, and counters kept somewhere else
+    void set(int id, uint32_t value) { _values[id].store(value, std::memory_order_relaxed); }
+    void min(int id, uint32_t value) {
+      uint32_t current = _values[id].load(std::memory_order_relaxed);
+      while (value < current &&
+             !_values[id].compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+    uint32_t get(int id) const { return _values[id].load(std::memory_order_relaxed); }
+
+    void snapshot(MetricsSnapshot &snapshot, uint32_t now) const;
+    // one line, rates against previous if given, returns the length
+    size_t format(const MetricsSnapshot &snapshot, const MetricsSnapshot *previous,
+                  char *buf, size_t size) const;
+
+  private:
+    std::atomic<uint32_t> _values[METRICS_MAX + 1];   // + spare slot
+    char _names[METRICS_MAX][METRICS_NAME_LEN];
+    MetricKind _kinds[METRICS_MAX];
+    uint8_t _count;
+};
+
+extern MetricsRegistry metrics;
+
+#endif
@@ -0,0 +1,101 @@
+#include "Mixer.h"
+
+// accumulator limits: 16 bit sample range in Q12
+#define ACC_MAX ((int32_t)INT16_MAX * MIXER_UNITY)
+#define ACC_MIN ((int32_t)INT16_MIN * MIXER_UNITY)
+
+// gain is clamped to unity, so even all voices at full scale fit the accumulator
+static_assert((int64_t)ACC_MAX * MIXER_VOICES < INT32_MAX, "too many voices for a 32 bit accumulator");
+
+
+bool Mixer::play(uint8_t voice, PcmSource &source, uint16_t gain, bool loop) {
+  if (voice >= MIXER_VOICES || !source.seek(0))
+    return false;
+
+  _voices[voice].source = &source;
+  _voices[voice].gain = gain > MIXER_UNITY ? MIXER_UNITY : gain;
+  _voices[voice].loop = loop;
+  _active[voice].store(true, std::memory_order_relaxed);
+  return true;
+}
+
+
+void Mixer::stop(uint8_t voice) {
+  if (voice >= MIXER_VOICES)
+    return;
+  _voices[voice].source = nullptr;
+  _active[voice].store(false, std::memory_order_relaxed);
+}
+
+
+void Mixer::stopAll() {
+  for (uint8_t v = 0; v < MIXER_VOICES; v++)
+    stop(v);
+}
+
+
+void Mixer::setGain(uint8_t voice, uint16_t gain) {
+  if (voice < MIXER_VOICES)
+    _voices[voice].gain = gain > MIXER_UNITY ? MIXER_UNITY : gain;
+}
+
+
+uint8_t Mixer::activeCount() const {
+  uint8_t count = 0;
+  for (uint8_t v = 0; v < MIXER_VOICES; v++)
+    count += active(v);
+  return count;
+}
+
+
+// fill the scratch buffer from a voice, rewinding looped sources and
+// stopping the voice once a one-shot source is exhausted
+size_t Mixer::readVoice(Voice &voice, size_t count) {
+  size_t done = 0;
+  bool rewound = false;
+  while (done < count) {
+    size_t n = voice.source->read(_scratch + done, count - done);
+    done += n;
+    if (done == count)
+      break;
+    // end of source: stop, unless looping and the source is not empty
+    if (!voice.loop || (n == 0 && rewound) || !voice.source->seek(0))
+      break;
+    rewound = true;
+  }
+  return done;
+}
+
+
+size_t Mixer::mix(int32_t *out, size_t count) {
+  if (count > MIXER_BLOCK)
+    count = MIXER_BLOCK;
+
+  for (size_t i = 0; i < count; i++)
+    _acc[i] = 0;
+
+  for (uint8_t v = 0; v < MIXER_VOICES; v++) {
+    Voice &voice = _voices[v];
+    if (voice.source == nullptr)
+      continue;
+
+    size_t n = readVoice(voice, count);
+    int32_t gain = voice.gain;
+    for (size_t i = 0; i < n; i++)
+      _acc[i] += _scratch[i] * gain;
+
+    if (n < count)
+      stop(v);
+  }
+
+  // saturate to 16 bit range, then widen Q12 to the 32 bit I2S sample
+  for (size_t i = 0; i < count; i++) {
+    int32_t acc = _acc[i];
+    if (acc > ACC_MAX)
+      acc = ACC_MAX;
+    else if (acc < ACC_MIN)
+      acc = ACC_MIN;
+    out[i] = acc << 4;
+  }
+  return count;
+}
@@ -0,0 +1,51 @@
+#ifndef Mixer_h
+#define Mixer_h
+
+#include <atomic>
+
+#include "PcmSource.h"
+
+#define MIXER_VOICES 6       // fixed number of voices
+#define MIXER_BLOCK  256     // max samples per mix() call
+#define MIXER_UNITY  4096    // voice gain of 1.0 (Q12)
+
+//
+// Fixed voice software mixer.
+//
+// Every voice plays a mono 16 bit PcmSource with its own gain. mix() sums
+// all active voices into 32 bit I2S samples with saturation. All buffers are
+// members, nothing is allocated while mixing.
+//
+// play/stop/setGain and mix() must be called from the same task (the audio
+// task), active() may be polled from anywhere.
+//
+class Mixer {
+  public:
+    // start source on voice, restarting whatever played there before
+    bool play(uint8_t voice, PcmSource &source, uint16_t gain = MIXER_UNITY, bool loop = false);
+    void stop(uint8_t voice);
+    void stopAll();
+    void setGain(uint8_t voice, uint16_t gain);
+
+    bool active(uint8_t voice) const { return voice < MIXER_VOICES && _active[voice].load(std::memory_order_relaxed); }
+    uint8_t activeCount() const;
+
+    // mix count samples (at most MIXER_BLOCK) into out, returns count
+    size_t mix(int32_t *out, size_t count);
+
+  private:
+    struct Voice {
+      PcmSource *source = nullptr;
+      uint16_t gain = 0;
+      bool loop = false;
+    };
+
+    size_t readVoice(Voice &voice, size_t count);
+
+    Voice _voices[MIXER_VOICES];
+    std::atomic<bool> _active[MIXER_VOICES] = {};
+    int16_t _scratch[MIXER_BLOCK];
+    int32_t _acc[MIXER_BLOCK];
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "MotionDetector.h"
+#include "FixedMath.h"
+
+
+bool MotionDetector::update(const MotionSample &s, uint32_t now, MotionEvent &event) {
+  // rotation rate in deg/s: raw / 16.4 ~ raw * 1000 >> 14
+  int32_t gx = (s.gx * 1000) >> 14;
+  int32_t gy = (s.gy * 1000) >> 14;
+  int32_t gz = (s.gz * 1000) >> 14;
+  int32_t rate = isqrt32(gx * gx + gy * gy + gz * gz);
+
+  // one pole low pass, 1/8 per sample
+  _speedQ4 += ((rate << 4) - _speedQ4) >> 3;
+  int32_t speed = _speedQ4 >> 4;
+  _speed.store(speed > 0xffff ? 0xffff : speed, std::memory_order_relaxed);
+
+  // gravity estimate, starts at the first sample
+  int32_t a[3] = { s.ax, s.ay, s.az };
+  if (!_primed) {
+    for (int i = 0; i < 3; i++)
+      _gravity[i] = a[i] << 6;
+    _primed = true;
+  }
+  uint32_t squares = 0;
+  for (int i = 0; i < 3; i++) {
+    _gravity[i] += ((a[i] << 6) - _gravity[i]) >> 6;
+    int32_t d = a[i] - (_gravity[i] >> 6);
+    if (d > 4 * MOTION_ACCEL_1G)    // +-4 g per axis keeps the sum in 32 bits
+      d = 4 * MOTION_ACCEL_1G;
+    else if (d < -4 * MOTION_ACCEL_1G)
+      d = -4 * MOTION_ACCEL_1G;
+    squares += d * d;
+  }
+  int32_t shock = isqrt32(squares) * 1000 / MOTION_ACCEL_1G;   // milli g
+
+  if (shock > _config.clashThreshold && (!_clashed || now - _lastClash > _config.clashHoldoff)) {
+    _clashed = true;
+    _lastClash = now;
+    event.type = MOTION_CLASH;
+    event.strength = shock > 0xffff ? 0xffff : shock;
+    event.time = now;
+    return true;
+  }
+
+  if (!_swinging && speed > _config.swingThreshold) {
+    _swinging = true;
+    event.type = MOTION_SWING;
+    event.strength = speed > 0xffff ? 0xffff : speed;
+    event.time = now;
+    return true;
+  }
+  if (_swinging && speed < _config.swingRelease)
+    _swinging = false;
+
+  return false;
+}
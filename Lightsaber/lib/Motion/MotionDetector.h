@@ -0,0 +1,56 @@
+#ifndef MotionDetector_h
+#define MotionDetector_h
+
+#include <atomic>
+
+#include "MotionSensor.h"
+
+enum MotionEventType {
+  MOTION_SWING,
+  MOTION_CLASH
+};
+
+struct MotionEvent {
+  uint8_t type;
+  uint16_t strength;    // swing: deg/s, clash: milli g
+  uint32_t time;        // ms
+};
+
+//
+// Swing and clash detection on raw IMU samples, integer math only.
+//
+// Swing speed is the low passed magnitude of the rotation rate. A swing is
+// reported when the speed rises through swingThreshold and is re-armed once
+// it drops below swingRelease. A clash is a spike of the accelerometer after
+// gravity (a slow low pass per axis) has been removed.
+//
+class MotionDetector {
+  public:
+    struct Config {
+      uint16_t swingThreshold = 250;   // deg/s
+      uint16_t swingRelease = 120;     // deg/s
+      uint16_t clashThreshold = 2500;  // milli g
+      uint16_t clashHoldoff = 150;     // ms between clashes
+    };
+
+    MotionDetector() {}
+    MotionDetector(const Config &config) : _config(config) {}
+
+    // feed one sample, returns true and fills event if something happened
+    bool update(const MotionSample &sample, uint32_t now, MotionEvent &event);
+
+    // current swing speed in deg/s, readable from any task
+    uint16_t swingSpeed() const { return _speed.load(std::memory_order_relaxed); }
+
+  private:
+    Config _config;
+    int32_t _speedQ4 = 0;            // low passed swing speed, deg/s in Q4
+    int32_t _gravity[3] = {0, 0, 0}; // low passed accel per axis, Q6
+    bool _primed = false;
+    bool _swinging = false;
+    uint32_t _lastClash = 0;
+    bool _clashed = false;
+    std::atomic<uint16_t> _speed{0};
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef MotionSensor_h
+#define MotionSensor_h
+
+#include <stdint.h>
+
+// one raw IMU reading, accel in 1/4096 g, gyro in 1/16.4 deg/s
+struct MotionSample {
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;
+};
+
+#define MOTION_ACCEL_1G   4096
+
+//
+// Accelerometer / gyro behind a minimal interface, the detector does not
+// care whether the samples come from I2C or from a recorded trace.
+//
+class MotionSensor {
+  public:
+    virtual ~MotionSensor() {}
+    virtual bool begin() = 0;
+    virtual bool read(MotionSample &sample) = 0;
+};
+
+#endif
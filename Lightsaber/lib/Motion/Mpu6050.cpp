@@ -0,0 +1,58 @@
+#ifdef ARDUINO
+
+#include <Wire.h>
+
+#include "Mpu6050.h"
+
+#define REG_SMPLRT_DIV    0x19
+#define REG_CONFIG        0x1a
+#define REG_GYRO_CONFIG   0x1b
+#define REG_ACCEL_CONFIG  0x1c
+#define REG_ACCEL_XOUT_H  0x3b
+#define REG_PWR_MGMT_1    0x6b
+#define REG_WHO_AM_I      0x75
+
+
+bool Mpu6050::writeRegister(uint8_t reg, uint8_t value) {
+  _wire.beginTransmission(_address);
+  _wire.write(reg);
+  _wire.write(value);
+  return _wire.endTransmission() == 0;
+}
+
+
+bool Mpu6050::begin() {
+  _wire.begin();
+  _wire.setClock(400000);
+
+  return writeRegister(REG_PWR_MGMT_1, 0x01)       // wake up, gyro x clock
+      && writeRegister(REG_CONFIG, 0x01)           // 184 Hz low pass, 1 kHz rate
+      && writeRegister(REG_SMPLRT_DIV, 0x00)
+      && writeRegister(REG_GYRO_CONFIG, 0x18)      // +-2000 deg/s
+      && writeRegister(REG_ACCEL_CONFIG, 0x10);    // +-8 g
+}
+
+
+bool Mpu6050::read(MotionSample &sample) {
+  uint8_t raw[14];
+
+  _wire.beginTransmission(_address);
+  _wire.write(REG_ACCEL_XOUT_H);
+  if (_wire.endTransmission(false) != 0)
+    return false;
+  if (_wire.requestFrom(_address, (uint8_t)14) != 14)
+    return false;
+  for (int i = 0; i < 14; i++)
+    raw[i] = _wire.read();
+
+  // big endian registers, temperature in between is skipped
+  sample.ax = (int16_t)(raw[0] << 8 | raw[1]);
+  sample.ay = (int16_t)(raw[2] << 8 | raw[3]);
+  sample.az = (int16_t)(raw[4] << 8 | raw[5]);
+  sample.gx = (int16_t)(raw[8] << 8 | raw[9]);
+  sample.gy = (int16_t)(raw[10] << 8 | raw[11]);
+  sample.gz = (int16_t)(raw[12] << 8 | raw[13]);
+  return true;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef Mpu6050_h
+#define Mpu6050_h
+
+#include "MotionSensor.h"
+
+class TwoWire;
+
+//
+// MPU-6050 / MPU-6500 over I2C: accel +-8 g, gyro +-2000 deg/s, 1 kHz
+// internal rate with the 184 Hz low pass.
+//
+class Mpu6050 : public MotionSensor {
+  public:
+    Mpu6050(TwoWire &wire, uint8_t address = 0x68) : _wire(wire), _address(address) {}
+
+    bool begin() override;
+    bool read(MotionSample &sample) override;
+
+  private:
+    bool writeRegister(uint8_t reg, uint8_t value);
+
+    TwoWire &_wire;
+    uint8_t _address;
+};
+
+#endif
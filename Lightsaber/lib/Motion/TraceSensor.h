@@ -0,0 +1,41 @@
+#ifndef TraceSensor_h
+#define TraceSensor_h
+
+#include <stddef.h>
+
+#include "MotionSensor.h"
+
+//
+// Replays a recorded trace of samples, used to run and time the motion
+// detection on the host without hardware.
+//
+class TraceSensor : public MotionSensor {
+  public:
+    TraceSensor(const MotionSample *samples, size_t count, bool loop = false)
+      : _samples(samples), _count(count), _loop(loop) {}
+
+    bool begin() override {
+      _position = 0;
+      return _count > 0;
+    }
+
+    bool read(MotionSample &sample) override {
+      if (_position == _count) {
+        if (!_loop || _count == 0)
+          return false;
+        _position = 0;
+      }
+      sample = _samples[_position++];
+      return true;
+    }
+
+    size_t position() const { return _position; }
+
+  private:
+    const MotionSample *_samples;
+    size_t _count;
+    size_t _position = 0;
+    bool _loop;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#include "MultiStrip.h"
+
+
+void MultiStrip::attach(uint8_t strip, StripDriver *driver) {
+  if (strip < STRIP_MAX)
+    _strips[strip] = driver;
+}
+
+
+void MultiStrip::show(const uint32_t *frame, uint16_t count) {
+  if (count < _map.frameLength())
+    return;
+
+  for (uint8_t i = 0; i < _map.strips(); i++) {
+    if (_strips[i] == nullptr)
+      continue;
+    _map.gather(i, frame, _segment);
+    _strips[i]->show(_segment, _map.segment(i).count);
+  }
+}
@@ -0,0 +1,30 @@
+#ifndef MultiStrip_h
+#define MultiStrip_h
+
+#include "SegmentMap.h"
+#include "StripDriver.h"
+
+//
+// One StripDriver in front of several strips.
+//
+// show() cuts the frame into the segments of the SegmentMap and hands each
+// one to its strip. The RMT strips only encode and start the transfer, so
+// all strips are on the wire at the same time and a frame takes as long as
+// the longest segment, not the sum of them.
+//
+class MultiStrip : public StripDriver {
+  public:
+    MultiStrip(const SegmentMap &map) : _map(map) {}
+
+    // strip i shows segment i of the map
+    void attach(uint8_t strip, StripDriver *driver);
+
+    void show(const uint32_t *frame, uint16_t count) override;
+
+  private:
+    const SegmentMap &_map;
+    StripDriver *_strips[STRIP_MAX] = {};
+    uint32_t _segment[STRIP_MAX_PIXELS];    // one segment in wire order
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "SegmentMap.h"
+
+
+bool SegmentMap::begin(uint16_t numPixels, uint8_t strips, SegmentMode mode, uint8_t reversed) {
+  _strips = 0;
+  _frameLength = 0;
+  if (strips == 0 || strips > STRIP_MAX || numPixels < strips)
+    return false;
+  if (mode == SEGMENT_MIRRORED ? (uint32_t)numPixels * strips > STRIP_MAX_PIXELS
+                               : numPixels > STRIP_MAX_PIXELS)
+    return false;
+
+  uint16_t first = 0;
+  for (uint8_t i = 0; i < strips; i++) {
+    Segment &s = _segments[i];
+    s.reversed = reversed & (1 << i);
+    if (mode == SEGMENT_MIRRORED) {
+      s.first = 0;
+      s.count = numPixels;
+    } else {
+      s.first = first;
+      s.count = i == strips - 1 ? numPixels - first : numPixels / strips;
+      first += s.count;
+    }
+  }
+  _strips = strips;
+  _frameLength = numPixels;
+  return true;
+}
+
+
+void SegmentMap::gather(uint8_t strip, const uint32_t *frame, uint32_t *out) const {
+  const Segment &s = _segments[strip];
+  const uint32_t *in = frame + s.first;
+
+  if (s.reversed) {
+    for (uint16_t i = 0; i < s.count; i++)
+      out[i] = in[s.count - 1 - i];
+  } else {
+    for (uint16_t i = 0; i < s.count; i++)
+      out[i] = in[i];
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef SegmentMap_h
+#define SegmentMap_h
+
+#include <stdint.h>
+
+#define STRIP_MAX        4      // strips driven in parallel
+#define STRIP_MAX_PIXELS 600    // pixels over all strips, bounds the RMT symbol memory
+
+enum SegmentMode : uint8_t {
+  SEGMENT_MIRRORED,      // every strip shows the whole frame
+  SEGMENT_INDEPENDENT    // the frame is split into one segment per strip
+};
+
+// the part of the frame a strip shows
+struct Segment {
+  uint16_t first;        // first frame pixel
+  uint16_t count;
+  bool reversed;         // the strip runs from the tip back to the hilt
+};
+
+//
+// Maps the blade frame onto 1..STRIP_MAX strips, pure logic.
+//
+// Mirrored, each strip gets the whole frame (dual sided blades). Independent,
+// the frame is cut into equal segments, the last one takes the remainder,
+// so a long blade can be spread over several strips that are sent at the
+// same time. A reversed strip gets its segment tip first, e.g. the return
+// half of a folded strip.
+//
+class SegmentMap {
+  public:
+    // reversed has one bit per strip, false if the geometry does not fit
+    bool begin(uint16_t numPixels, uint8_t strips, SegmentMode mode, uint8_t reversed = 0);
+
+    uint8_t strips() const { return _strips; }
+    uint16_t frameLength() const { return _frameLength; }
+    const Segment &segment(uint8_t strip) const { return _segments[strip]; }
+
+    // copy the pixels of one strip out of the frame in wire order
+    void gather(uint8_t strip, const uint32_t *frame, uint32_t *out) const;
+
+  private:
+    Segment _segments[STRIP_MAX];
+    uint8_t _strips = 0;
+    uint16_t _frameLength = 0;
+};
+
+#endif
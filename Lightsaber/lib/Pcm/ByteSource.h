@@ -0,0 +1,21 @@
+#ifndef ByteSource_h
+#define ByteSource_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Minimal random access byte stream.
+//
+// On the device this wraps a SPIFFS File, on the host a FILE* or a memory
+// buffer, so everything reading through it can run on Linux.
+//
+class ByteSource {
+  public:
+    virtual ~ByteSource() {}
+    virtual size_t read(uint8_t *data, size_t len) = 0;
+    virtual bool seek(uint32_t pos) = 0;
+    virtual uint32_t size() = 0;
+};
+
+#endif
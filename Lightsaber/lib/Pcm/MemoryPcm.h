@@ -0,0 +1,42 @@
+#ifndef MemoryPcm_h
+#define MemoryPcm_h
+
+#include "PcmSource.h"
+
+//
+// PcmSource over samples already in memory, e.g. a sound bank entry in
+// memory mapped flash.
+//
+class MemoryPcm : public PcmSource {
+  public:
+    void begin(const int16_t *samples, uint32_t length) {
+      _samples = samples;
+      _length = length;
+      _position = 0;
+    }
+
+    size_t read(int16_t *data, size_t count) override {
+      if (count > _length - _position)
+        count = _length - _position;
+      for (size_t i = 0; i < count; i++)
+        data[i] = _samples[_position + i];
+      _position += count;
+      return count;
+    }
+
+    bool seek(uint32_t sample) override {
+      if (sample > _length)
+        return false;
+      _position = sample;
+      return true;
+    }
+
+    uint32_t length() const override { return _length; }
+
+  private:
+    const int16_t *_samples = nullptr;
+    uint32_t _length = 0;
+    uint32_t _position = 0;
+};
+
+#endif
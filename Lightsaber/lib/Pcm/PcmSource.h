@@ -0,0 +1,20 @@
+#ifndef PcmSource_h
+#define PcmSource_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Seekable source of mono 16 bit PCM samples.
+//
+class PcmSource {
+  public:
+    virtual ~PcmSource() {}
+    // read up to count samples, returns less only at the end of the data
+    virtual size_t read(int16_t *data, size_t count) = 0;
+    virtual bool seek(uint32_t sample) = 0;
+    // total number of samples
+    virtual uint32_t length() const = 0;
+};
+
+#endif
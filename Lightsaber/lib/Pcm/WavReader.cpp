@@ -0,0 +1,97 @@
+#include <string.h>
+
+#include "WavReader.h"
+
+
+static uint32_t le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+
+bool WavReader::begin(ByteSource &source) {
+  uint8_t header[12];
+
+  _source = &source;
+  _length = 0;
+  _position = 0;
+  _channels = 0;
+
+  if (!source.seek(0) || source.read(header, 12) != 12)
+    return false;
+  if (memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0)
+    return false;
+
+  // walk the chunks until we have seen "fmt " and reached "data"
+  uint32_t pos = 12;
+  uint32_t end = source.size();
+  while (pos + 8 <= end) {
+    uint8_t chunk[8];
+    if (!source.seek(pos) || source.read(chunk, 8) != 8)
+      return false;
+    uint32_t len = le32(chunk + 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[16];
+      if (len < 16 || source.read(fmt, 16) != 16)
+        return false;
+      if (le16(fmt) != 1 || le16(fmt + 14) != 16)   // PCM, 16 bit only
+        return false;
+      _channels = le16(fmt + 2);
+      _sampleRate = le32(fmt + 4);
+      if (_channels != 1 && _channels != 2)
+        return false;
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (_channels == 0)
+        return false;
+      _dataOffset = pos + 8;
+      if (len > end - _dataOffset)
+        len = end - _dataOffset;
+      _length = len / (2 * _channels);
+      return source.seek(_dataOffset);
+    }
+    pos += 8 + len + (len & 1);   // chunks are word aligned
+  }
+  return false;
+}
+
+
+bool WavReader::seek(uint32_t sample) {
+  if (_source == nullptr || sample > _length)
+    return false;
+  _position = sample;
+  return _source->seek(_dataOffset + sample * 2 * _channels);
+}
+
+
+size_t WavReader::read(int16_t *data, size_t count) {
+  if (_source == nullptr)
+    return 0;
+  if (count > _length - _position)
+    count = _length - _position;
+
+  size_t done = 0;
+  if (_channels == 1) {
+    done = _source->read((uint8_t *)data, count * 2) / 2;
+  } else {
+    // read interleaved frames in small chunks and mix them down
+    int16_t frame[64];
+    while (done < count) {
+      size_t n = count - done;
+      if (n > 32)
+        n = 32;
+      size_t got = _source->read((uint8_t *)frame, n * 4) / 4;
+      for (size_t i = 0; i < got; i++) {
+        data[done + i] = (int16_t)(((int32_t)frame[2 * i] + frame[2 * i + 1]) >> 1);
+      }
+      done += got;
+      if (got < n)
+        break;
+    }
+  }
+  _position += done;
+  return done;
+}
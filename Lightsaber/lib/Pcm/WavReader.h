@@ -0,0 +1,33 @@
+#ifndef WavReader_h
+#define WavReader_h
+
+#include "ByteSource.h"
+#include "PcmSource.h"
+
+//
+// Reads 16 bit PCM wav data as mono samples, stereo is mixed down.
+//
+// begin() parses the RIFF header once and remembers where the data chunk
+// starts, after that seek() and read() go straight to the sample data.
+//
+class WavReader : public PcmSource {
+  public:
+    bool begin(ByteSource &source);
+
+    size_t read(int16_t *data, size_t count) override;
+    bool seek(uint32_t sample) override;
+    uint32_t length() const override { return _length; }
+
+    uint32_t sampleRate() const { return _sampleRate; }
+    uint16_t channels() const { return _channels; }
+
+  private:
+    ByteSource *_source = nullptr;
+    uint32_t _dataOffset = 0;
+    uint32_t _length = 0;        // samples per channel
+    uint32_t _position = 0;
+    uint32_t _sampleRate = 0;
+    uint16_t _channels = 0;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "PowerLimiter.h"
+
+
+void PowerLimiter::begin(uint16_t budgetMa, uint8_t copies) {
+  _budgetMa = budgetMa;
+  _copies = copies ? copies : 1;
+  _scale = POWER_SCALE_ONE;
+  _target = POWER_SCALE_ONE;
+}
+
+
+uint16_t PowerLimiter::update(uint32_t channelSum, uint16_t count) {
+  uint32_t idle = (uint32_t)count * POWER_IDLE_MA * _copies;
+  uint32_t full = (uint64_t)channelSum * POWER_CHANNEL_MA * _copies / 255;
+
+  // the scale that fits the budget
+  uint32_t target = POWER_SCALE_ONE;
+  if (_budgetMa > 0) {
+    if (idle >= _budgetMa)
+      target = 0;
+    else if (full > _budgetMa - idle)
+      target = (uint32_t)(_budgetMa - idle) * POWER_SCALE_ONE / full;
+  }
+
+  _target = target;
+  if (target < _scale)
+    _scale = target;
+  else if (target - _scale > POWER_RISE)
+    _scale += POWER_RISE;
+  else
+    _scale = target;
+
+  _currentMa = idle + full * _scale / POWER_SCALE_ONE;
+  return _scale;
+}
@@ -0,0 +1,50 @@
+#ifndef PowerLimiter_h
+#define PowerLimiter_h
+
+#include <stdint.h>
+
+// WS2812 estimate: 20 mA per channel at full value, 1 mA per idle pixel
+#define POWER_CHANNEL_MA  20
+#define POWER_IDLE_MA     1
+#define POWER_SCALE_ONE   256
+#define POWER_RISE        8      // scale steps per frame on the way back up
+
+//
+// Keeps the strip current under a budget.
+//
+// The output pass sums the channel values of every frame before it is
+// sent and hands the sum to update(). From that the limiter estimates the
+// current the frame would draw unscaled and sets the scale for that same
+// frame: over budget it drops at once, so no frame is ever sent above the
+// budget; under budget it creeps back up by POWER_RISE per frame so the
+// blade does not pump.
+//
+class PowerLimiter {
+  public:
+    // budgetMa 0 disables the limiter, copies is how many strips show the
+    // same frame (mirrored strips draw current each)
+    void begin(uint16_t budgetMa, uint8_t copies = 1);
+
+    // channelSum is the sum of all channel values of the frame about to be
+    // sent, unscaled, count its pixels. Returns the scale to send it at,
+    // POWER_SCALE_ONE = 1.0
+    uint16_t update(uint32_t channelSum, uint16_t count);
+
+    // scale of the last frame
+    uint16_t scale() const { return _scale; }
+    // the scale is still creeping up, the next frame is brighter
+    bool rising() const { return _scale < _target; }
+
+    // estimated current of the last frame as sent
+    uint32_t currentMa() const { return _currentMa; }
+    uint16_t budgetMa() const { return _budgetMa; }
+
+  private:
+    uint16_t _budgetMa = 0;
+    uint8_t _copies = 1;
+    uint16_t _scale = POWER_SCALE_ONE;
+    uint16_t _target = POWER_SCALE_ONE;
+    uint32_t _currentMa = 0;
+};
+
+#endif
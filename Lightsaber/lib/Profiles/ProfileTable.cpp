@@ -0,0 +1,38 @@
+#include "ProfileTable.h"
+
+
+bool ProfileTable::add(const Profile &profile) {
+  if (_count == PROFILE_MAX)
+    return false;
+  _profiles[_count++] = profile;
+  return true;
+}
+
+
+bool ProfileTable::select(uint8_t i) {
+  if (i >= _count)
+    return false;
+  _current.store(i, std::memory_order_relaxed);
+  return true;
+}
+
+
+uint8_t ProfileTable::next() {
+  if (_count == 0)
+    return 0;
+  uint8_t i = index() + 1;
+  if (i >= _count)
+    i = 0;
+  _current.store(i, std::memory_order_relaxed);
+  return i;
+}
+
+
+uint8_t ProfileTable::previous() {
+  if (_count == 0)
+    return 0;
+  uint8_t i = index();
+  i = i == 0 ? _count - 1 : i - 1;
+  _current.store(i, std::memory_order_relaxed);
+  return i;
+}
@@ -0,0 +1,59 @@
+#ifndef ProfileTable_h
+#define ProfileTable_h
+
+#include <stdint.h>
+#include <atomic>
+
+#define PROFILE_MAX      8
+#define PROFILE_NAME_LEN 12
+
+// how the blade brightness moves while it is on
+enum FlickerStyle : uint8_t {
+  FLICKER_STEADY,     // constant brightness
+  FLICKER_AUDIO,      // follows the envelope of the mixed audio
+  FLICKER_UNSTABLE,   // audio plus random crackle
+  FLICKER_COUNT
+};
+
+struct Profile {
+  char name[PROFILE_NAME_LEN];
+  uint32_t color;          // 0x00RRGGBB at full scale
+  uint8_t brightness;      // 0..255
+  uint8_t ignitionCurve;   // IgnitionCurve
+  uint8_t retractCurve;
+  uint8_t humSet;          // index of the hum / swing hum pair
+  uint8_t flicker;         // FlickerStyle
+  uint16_t volume;         // mixer gain, MIXER_UNITY is 1.0
+};
+
+//
+// Blade profiles, filled once at setup and switched at runtime.
+//
+// The table is a fixed array of PODs, switching only stores the new index,
+// so it never allocates, reads no files and takes effect with the next LED
+// frame. Profiles must not be added once other tasks read current().
+//
+class ProfileTable {
+  public:
+    // false if the table is full
+    bool add(const Profile &profile);
+
+    uint8_t count() const { return _count; }
+    uint8_t index() const { return _current.load(std::memory_order_relaxed); }
+    const Profile &current() const { return _profiles[index()]; }
+    const Profile &profile(uint8_t i) const { return _profiles[i]; }
+
+    // false if there is no profile i
+    bool select(uint8_t i);
+    // select the next / previous profile, wrapping around, returns the new
+    // index. An empty table stays at 0.
+    uint8_t next();
+    uint8_t previous();
+
+  private:
+    Profile _profiles[PROFILE_MAX];
+    uint8_t _count = 0;
+    std::atomic<uint8_t> _current{0};
+};
+
+#endif
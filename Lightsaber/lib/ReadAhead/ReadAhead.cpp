@@ -0,0 +1,97 @@
+#include <string.h>
+
+#include "ReadAhead.h"
+
+
+void ReadAhead::begin(ByteSource &source, uint8_t watermark) {
+  _filled.reset();
+  _free.reset();
+  for (uint8_t i = 0; i < READAHEAD_BLOCKS; i++)
+    _free.push(i);
+
+  _source = &source;
+  _watermark = watermark == 0 || watermark > READAHEAD_BLOCKS ? READAHEAD_BLOCKS : watermark;
+  _current = -1;
+  _offset = 0;
+  _sourceDone = false;
+}
+
+
+size_t ReadAhead::fill() {
+  size_t blocks = 0;
+
+  while (!_sourceDone.load(std::memory_order_relaxed) && _filled.available() < _watermark) {
+    uint8_t index;
+    if (!_free.pop(index))
+      break;
+
+    size_t n = _source->read(_pool[index], READAHEAD_BLOCK);
+    _size[index] = n;
+    // an empty block still goes through the queue, it marks the end. The
+    // last block is queued before _sourceDone is set, otherwise eof() can
+    // see the flag with an empty queue and drop it
+    _filled.push(index);
+    if (n < READAHEAD_BLOCK)
+      _sourceDone.store(true, std::memory_order_release);
+    blocks++;
+  }
+  return blocks;
+}
+
+
+// make sure _current is a block with unread data
+bool ReadAhead::nextBlock() {
+  while (_current < 0 || _offset == _size[_current]) {
+    if (_current >= 0) {
+      _free.push(_current);
+      _current = -1;
+    }
+    uint8_t index;
+    if (!_filled.pop(index))
+      return false;
+    _current = index;
+    _offset = 0;
+    if (_size[index] == 0 && _filled.available() == 0)
+      return false;
+  }
+  return true;
+}
+
+
+size_t ReadAhead::read(uint8_t *data, size_t len) {
+  size_t done = 0;
+
+  while (done < len) {
+    if (!nextBlock()) {
+      if (!eof())
+        _stalls.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+    size_t n = _size[_current] - _offset;
+    if (n > len - done)
+      n = len - done;
+    memcpy(data + done, _pool[_current] + _offset, n);
+    _offset += n;
+    done += n;
+  }
+  return done;
+}
+
+
+int ReadAhead::peek() {
+  if (!nextBlock())
+    return -1;
+  return _pool[_current][_offset];
+}
+
+
+size_t ReadAhead::buffered() const {
+  size_t bytes = _current >= 0 ? _size[_current] - _offset : 0;
+  return bytes + _filled.available() * READAHEAD_BLOCK;
+}
+
+
+bool ReadAhead::eof() const {
+  return _sourceDone.load(std::memory_order_acquire) && _filled.available() == 0 &&
+         (_current < 0 || _offset == _size[_current]);
+}
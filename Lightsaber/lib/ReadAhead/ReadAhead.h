@@ -0,0 +1,58 @@
+#ifndef ReadAhead_h
+#define ReadAhead_h
+
+#include <atomic>
+
+#include "ByteSource.h"
+#include "SpscRing.h"
+
+#define READAHEAD_BLOCK   4096   // bytes per flash read
+#define READAHEAD_BLOCKS  4      // blocks in the pool, power of two
+
+//
+// Read-ahead buffer between a slow ByteSource (flash) and a decoder.
+//
+// A filler task calls fill(), which reads whole blocks from the source
+// until 'watermark' blocks are buffered. The decoder calls read(), which
+// only copies from blocks that are already in RAM, so flash latency never
+// lands in the decode path. When the decoder finds nothing buffered before
+// the end of the source, that is counted as a stall.
+//
+// fill() and read() may run in different tasks (one each). begin() must
+// not run concurrently with either of them.
+//
+class ReadAhead {
+  public:
+    void begin(ByteSource &source, uint8_t watermark = READAHEAD_BLOCKS);
+
+    // filler side, returns the number of blocks read
+    size_t fill();
+
+    // decoder side
+    size_t read(uint8_t *data, size_t len);
+    int peek();
+    size_t buffered() const;       // bytes readable without stalling
+    bool eof() const;              // source exhausted and everything read
+
+    uint32_t stalls() const { return _stalls.load(std::memory_order_relaxed); }
+
+  private:
+    bool nextBlock();
+
+    uint8_t _pool[READAHEAD_BLOCKS][READAHEAD_BLOCK] __attribute__((aligned(4)));
+    uint16_t _size[READAHEAD_BLOCKS];
+    SpscRing<uint8_t, READAHEAD_BLOCKS> _filled;   // filler -> decoder
+    SpscRing<uint8_t, READAHEAD_BLOCKS> _free;     // decoder -> filler
+
+    // filler side
+    ByteSource *_source = nullptr;
+    uint8_t _watermark = READAHEAD_BLOCKS;
+    std::atomic<bool> _sourceDone{true};
+
+    // decoder side
+    int _current = -1;
+    size_t _offset = 0;
+    std::atomic<uint32_t> _stalls{0};
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifdef ARDUINO
+
+#include "ReadAheadStream.h"
+
+
+bool ReadAheadStream::begin(uint8_t watermark, int core, int priority) {
+  _watermark = watermark;
+  _lock = xSemaphoreCreateMutex();
+  return _lock != nullptr &&
+         xTaskCreatePinnedToCore(fillTask, "readahead", 3072, this, priority, nullptr, core) == pdPASS;
+}
+
+
+void ReadAheadStream::fillTask(void *arg) {
+  ReadAheadStream *stream = (ReadAheadStream *)arg;
+
+  while (true) {
+    size_t blocks = 0;
+    xSemaphoreTake(stream->_lock, portMAX_DELAY);
+    if (stream->_open)
+      blocks = stream->_ahead.fill();
+    xSemaphoreGive(stream->_lock);
+
+    if (blocks == 0)
+      vTaskDelay(pdMS_TO_TICKS(2));   // buffer is full (or nothing open)
+  }
+}
+
+
+void ReadAheadStream::open(fs::File file) {
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  _file.close();
+  _file = file;
+  _ahead.begin(_source, _watermark);
+  _open = (bool)_file;
+  xSemaphoreGive(_lock);
+}
+
+
+void ReadAheadStream::close() {
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  _open = false;
+  _file.close();
+  xSemaphoreGive(_lock);
+}
+
+
+int ReadAheadStream::available() {
+  if (!_open || _ahead.eof())
+    return 0;
+  size_t n = _ahead.buffered();
+  return n > 0 ? n : 1;     // still data to come
+}
+
+
+int ReadAheadStream::read() {
+  uint8_t b;
+  return _open && _ahead.read(&b, 1) == 1 ? b : -1;
+}
+
+
+int ReadAheadStream::peek() {
+  return _open ? _ahead.peek() : -1;
+}
+
+
+size_t ReadAheadStream::readBytes(char *buffer, size_t length) {
+  return _open ? _ahead.read((uint8_t *)buffer, length) : 0;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef ReadAheadStream_h
+#define ReadAheadStream_h
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/semphr.h>
+
+#include "ReadAhead.h"
+
+// ByteSource on top of an Arduino file
+class FileSource : public ByteSource {
+  public:
+    FileSource(fs::File &file) : file(file) {}
+    size_t read(uint8_t *data, size_t len) override { return file.read(data, len); }
+    bool seek(uint32_t pos) override { return file.seek(pos); }
+    uint32_t size() override { return file.size(); }
+  private:
+    fs::File &file;
+};
+
+//
+// Arduino Stream reading a file through a ReadAhead buffer.
+//
+// begin() starts a filler task that keeps the buffer topped up from flash,
+// the decoder reads the stream from loop() as before. available() stays
+// non zero until the end of the file, a read that finds the buffer empty
+// returns nothing and is counted in stalls().
+//
+class ReadAheadStream : public Stream {
+  public:
+    bool begin(uint8_t watermark = READAHEAD_BLOCKS, int core = 0, int priority = 2);
+
+    // switch to a new file, the old one is closed. The stream owns the
+    // handle from here on, pass one nobody else uses (closing it would
+    // close theirs too)
+    void open(fs::File file);
+    void close();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t write(uint8_t) override { return 0; }
+
+    uint32_t stalls() const { return _ahead.stalls(); }
+
+  private:
+    static void fillTask(void *arg);
+
+    fs::File _file;
+    FileSource _source{_file};
+    ReadAhead _ahead;
+    uint8_t _watermark = READAHEAD_BLOCKS;
+    bool _open = false;
+    SemaphoreHandle_t _lock = nullptr;   // held by the filler while reading flash
+};
+
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+#ifdef ARDUINO
+
+#include <new>
+#include <driver/rmt.h>
+
+#include "RmtStrip.h"
+
+// 80 MHz APB / 2 = 25 ns per tick
+#define RMT_CLK_DIV 2
+#define T0H 16    // 0.40 us
+#define T0L 34    // 0.85 us
+#define T1H 32    // 0.80 us
+#define T1L 18    // 0.45 us
+
+
+RmtStrip::RmtStrip(int channel)
+  : _encoder(T0H, T0L, T1H, T1L), _channel(channel) {
+}
+
+
+bool RmtStrip::begin(int pin, uint16_t numPixels) {
+  rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, (rmt_channel_t)_channel);
+  config.clk_div = RMT_CLK_DIV;
+
+  if (rmt_config(&config) != ESP_OK || rmt_driver_install(config.channel, 0, 0) != ESP_OK)
+    return false;
+
+  // both symbol buffers are allocated once, show() never allocates
+  for (int i = 0; i < 2; i++) {
+    _symbols[i] = new (std::nothrow) uint32_t[numPixels * WS2812_SYMBOLS_PER_PIXEL];
+    if (_symbols[i] == nullptr)
+      return false;
+  }
+  _numPixels = numPixels;
+  return true;
+}
+
+
+bool RmtStrip::wait(uint32_t timeoutMs) {
+  if (!_sending)
+    return true;
+  if (rmt_wait_tx_done((rmt_channel_t)_channel, pdMS_TO_TICKS(timeoutMs)) != ESP_OK)
+    return false;
+  _sending = false;
+  return true;
+}
+
+
+void RmtStrip::show(const uint32_t *frame, uint16_t count) {
+  if (_numPixels == 0)
+    return;
+  if (count > _numPixels)
+    count = _numPixels;
+
+  // encode while the previous frame is still being sent
+  uint32_t *symbols = _symbols[_back];
+  _encoder.encode(frame, count, symbols);
+
+  // a frame of 300 pixels takes 9 ms, with the fps cap this rarely waits
+  wait(20);
+  rmt_write_items((rmt_channel_t)_channel, (const rmt_item32_t *)symbols,
+                  count * WS2812_SYMBOLS_PER_PIXEL, false);
+  _sending = true;
+  _back ^= 1;
+}
+
+#endif
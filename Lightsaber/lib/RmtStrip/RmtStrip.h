@@ -0,0 +1,37 @@
+#ifndef RmtStrip_h
+#define RmtStrip_h
+
+#include "Hal.h"
+#include "Ws2812Encoder.h"
+
+//
+// WS2812 output through the ESP32 RMT peripheral.
+//
+// show() encodes the frame into a symbol buffer and starts the RMT
+// transfer without waiting for it. Two symbol buffers are used, the next
+// frame is encoded while the previous one is still on the wire, so the CPU
+// never bit-bangs and interrupts stay enabled.
+//
+class RmtStrip : public LedStrip {
+  public:
+    // channel is an rmt_channel_t, one per strip
+    RmtStrip(int channel);
+
+    // pin and length come from the config, false if the channel can't be
+    // set up or the symbol buffers don't fit
+    bool begin(int pin, uint16_t numPixels) override;
+    void show(const uint32_t *frame, uint16_t count) override;
+
+    // wait until the last frame is out, true if the strip is idle
+    bool wait(uint32_t timeoutMs);
+
+  private:
+    Ws2812Encoder _encoder;
+    int _channel;
+    uint16_t _numPixels = 0;
+    uint32_t *_symbols[2] = { nullptr, nullptr };
+    uint8_t _back = 0;
+    bool _sending = false;
+};
+
+#endif
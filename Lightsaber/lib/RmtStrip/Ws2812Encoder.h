@@ -0,0 +1,42 @@
+#ifndef Ws2812Encoder_h
+#define Ws2812Encoder_h
+
+#include <stdint.h>
+
+#define WS2812_SYMBOLS_PER_PIXEL 24
+
+//
+// Encodes 0x00RRGGBB pixels into WS2812 bit symbols, GRB order, MSB first.
+//
+// A symbol is one 32 bit RMT item: high time in bits 0..14 with level 1 in
+// bit 15, low time in bits 16..30 with level 0 in bit 31. Plain integers,
+// so the encoder runs (and can be timed) on the host as well.
+//
+class Ws2812Encoder {
+  public:
+    // durations in RMT ticks
+    Ws2812Encoder(uint16_t t0h, uint16_t t0l, uint16_t t1h, uint16_t t1l)
+      : _zero(symbol(t0h, t0l)), _one(symbol(t1h, t1l)) {}
+
+    static uint32_t symbol(uint16_t high, uint16_t low) {
+      return (high & 0x7fff) | 0x8000 | ((uint32_t)(low & 0x7fff) << 16);
+    }
+
+    // symbols must hold count * WS2812_SYMBOLS_PER_PIXEL items
+    void encode(const uint32_t *frame, uint16_t count, uint32_t *symbols) const {
+      uint32_t diff = _zero ^ _one;
+      for (uint16_t i = 0; i < count; i++) {
+        uint32_t c = frame[i];
+        // GRB on the wire
+        uint32_t grb = ((c & 0x00ff00) << 8) | ((c & 0xff0000) >> 8) | (c & 0x0000ff);
+        for (int bit = 23; bit >= 0; bit--)
+          *symbols++ = _zero ^ (diff & (0 - ((grb >> bit) & 1)));
+      }
+    }
+
+  private:
+    uint32_t _zero;
+    uint32_t _one;
+};
+
+#endif
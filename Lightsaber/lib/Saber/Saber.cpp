@@ -0,0 +1,467 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Saber.h"
+#include "SaberTrace.h"
+#include "Log.h"
+
+
+// The configuration is a binary blob in the config partition (see
+// tools/config), read with a single flash read. config.json is the
+// fallback if the partition holds no valid blob.
+static const char *cfgfile = "/config.json";
+
+// bank names, SOUND_HUM is looked up through the hum sets
+static const char *soundNames[] = { "on", "off", nullptr, "swing", "hit" };
+
+// The hum loops from the bank, HumLoop wraps it seamlessly with a short
+// crossfade at the loop point. With a second hum loop in the bank the
+// smooth swing crossfades and pitches both by the swing speed.
+// All sets found in the bank are set up at boot so switching never touches
+// the bank again. Sets missing in the bank fall back to set 0.
+static const char *humNames[HUM_SETS][2] = {     // hum, swing hum
+  { "Hum-4", "idle" },
+  { "hum2", "swing2" },
+};
+
+// Profile 0 comes from the config, a double click switches to the next one
+static const Profile builtinProfiles[] = {
+  { "green",    0x00ff00, 20, CURVE_EASE_IN_OUT, CURVE_EASE_IN_OUT, 0, FLICKER_AUDIO,    MIXER_UNITY },
+  { "unstable", 0xff0800, 24, CURVE_FLICKER_IN,  CURVE_SQRT,        1, FLICKER_UNSTABLE, MIXER_UNITY },
+  { "purple",   0x8000ff, 20, CURVE_BOUNCE,      CURVE_SQRT,        0, FLICKER_STEADY,   MIXER_UNITY * 3 / 4 },
+};
+
+// names for the trace dump, in SaberTraceId order
+const char *const saberTraceNames[TRACE_IDS] = {
+  "loop", "button", "gesture", "motion", "motion event", "render", "led show",
+  "mix", "pcm fill", "i2s write", "underrun",
+};
+
+// The blade is drawn by the effect engine: the profile sets the base color
+// and flicker layers, clash, blaster and lockup are layered on top.
+#define LOCKUP_WIDTH  8        // pixels either side of the lockup spot
+#define BLASTER_WIDTH 3
+#define BLASTER_TIME  400      // ms
+#define FLASH_COLOR   0xffffff // clash, blaster and lockup
+
+
+Saber::Saber(const SaberHal &hal)
+  : _hal(hal), _audioUnderruns(0), _activeHum(&_humSets[0]), _output(_segments),
+    _leds(_output, LED_MAX_PIXELS, SABER_MAX_FPS), _blade(0) {
+  for (int i = 0; i < SOUND_COUNT; i++)
+    _soundIndex[i] = -1;
+
+  _loopsMetric = metrics.add("loops", METRIC_COUNTER);
+  _pcmMetric = metrics.add("pcm", METRIC_GAUGE);          // samples buffered before an I2S write
+  _pcmLowMetric = metrics.add("pcm_low", METRIC_MIN);
+  _underrunsMetric = metrics.add("underruns", METRIC_COUNTER);
+  _framesMetric = metrics.add("frames", METRIC_COUNTER);
+  _skippedMetric = metrics.add("skipped", METRIC_COUNTER);
+}
+
+
+void Saber::log(const char *format, ...) {
+  char line[128];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  _hal.print(line);
+}
+
+
+// xorshift32, seeded from the clock at the first use
+uint32_t Saber::random(uint32_t low, uint32_t high) {
+  if (_random == 0)
+    _random = _hal.clock.micros() | 1;
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  return high > low ? low + _random % (high - low) : low;
+}
+
+
+// fallback, parses config.json, missing keys keep defaults
+bool Saber::loadJsonConfig() {
+  static char json[CONFIG_JSON_MAX];
+
+  configDefaults(_cfg);
+  int32_t length = _hal.fs.read(cfgfile, json, sizeof(json));
+  if (length < 0)
+    return false;
+
+  const char *unknown = nullptr;
+  if (!configFromJson(json, length, _cfg, &unknown))
+    return false;
+  if (unknown)
+    log("config: unknown %s, using the default", unknown);
+  return true;
+}
+
+
+bool Saber::initConfig() {
+  uint32_t start = _hal.clock.micros();
+  size_t size = 0;
+  const uint8_t *blob = _hal.fs.map("config", size);
+  bool binary = blob != nullptr && size >= sizeof(_cfg);
+  if (binary) {
+    memcpy(&_cfg, blob, sizeof(_cfg));
+    binary = configCheck(_cfg);
+  }
+  uint32_t binaryTime = _hal.clock.micros() - start;
+
+  if (binary) {
+    log("config: binary %u us", binaryTime);
+  } else {
+    start = _hal.clock.micros();
+    if (!loadJsonConfig())
+      log("no config, using defaults");
+    log("config: no binary config (%u us), json %u us", binaryTime, _hal.clock.micros() - start);
+  }
+
+  if (_cfg.numPixels > LED_MAX_PIXELS)
+    _cfg.numPixels = LED_MAX_PIXELS;
+  if (!_segments.begin(_cfg.numPixels, _cfg.strips, (SegmentMode)_cfg.stripMode, _cfg.stripReversed)) {
+    log("%u pixels on %u strips do not fit, using one strip", _cfg.numPixels, _cfg.strips);
+    _cfg.strips = 1;
+    _segments.begin(_cfg.numPixels, 1, SEGMENT_MIRRORED, _cfg.stripReversed);
+  }
+  _leds.setNumPixels(_segments.frameLength());
+  _leds.setPowerBudget(_cfg.powerBudgetMa, _cfg.stripMode == SEGMENT_MIRRORED ? _cfg.strips : 1);
+  if (_cfg.ignitionCurve >= CURVE_COUNT)
+    _cfg.ignitionCurve = CURVE_SQRT;
+  if (_cfg.retractCurve >= CURVE_COUNT)
+    _cfg.retractCurve = CURVE_SQRT;
+  _blade.setNumPixels(_cfg.numPixels);
+
+  // the config only picks the sounds, the look of profile 0 is the config's
+  Profile profile = { "config", _cfg.color, _cfg.brightness, _cfg.ignitionCurve, _cfg.retractCurve,
+                      _cfg.soundProfile, FLICKER_AUDIO, MIXER_UNITY };
+  _profiles.add(profile);
+  for (const Profile &builtin : builtinProfiles)
+    _profiles.add(builtin);
+  applyProfile();
+  return true;
+}
+
+
+bool Saber::initButton() {
+  _hal.button.begin();
+  return true;
+}
+
+
+bool Saber::initStrip() {
+  bool ok = true;
+  for (uint8_t i = 0; i < _segments.strips(); i++) {
+    LedStrip *strip = _hal.strips[i];
+    if (strip != nullptr && strip->begin(_cfg.stripPins[i], _segments.segment(i).count)) {
+      _output.attach(i, strip);
+    } else {
+      log("failed to init strip %u on pin %u", i, _cfg.stripPins[i]);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+
+// the platform starts calling motionStep() if this succeeds
+bool Saber::initMotion() {
+  if (!_hal.imu.begin()) {
+    log("no IMU found, swing and clash disabled");
+    return false;
+  }
+  return true;
+}
+
+
+// map the sound bank partition and resolve the sounds we use
+bool Saber::initSoundBank() {
+  size_t size = 0;
+  const uint8_t *image = _hal.fs.map("soundbank", size);
+
+  if (image == nullptr || !_bank.begin(image, size)) {
+    log("no sound bank, flash one with tools/soundbank");
+    return false;
+  }
+  if (_bank.sampleRate() != SABER_SAMPLE_RATE) {
+    log("sound bank rate %u != %u", _bank.sampleRate(), SABER_SAMPLE_RATE);
+  }
+
+  for (int i=0; i<SOUND_COUNT; i++) {
+    _soundIndex[i] = soundNames[i] ? _bank.find(soundNames[i]) : -1;
+    if (soundNames[i] && _soundIndex[i] < 0) {
+      log("sound %s missing in bank", soundNames[i]);
+    }
+  }
+
+  for (int i=0; i<HUM_SETS; i++) {
+    HumSet &set = _humSets[i];
+    int index = _bank.find(humNames[i][0]);
+    if (index >= 0) {
+      set.humPcm.begin(_bank.samples(index), _bank.length(index));
+      set.humReady = set.hum.begin(set.humPcm, HUM_XFADE);
+    }
+    index = _bank.find(humNames[i][1]);
+    if (set.humReady && index >= 0) {
+      set.swingPcm.begin(_bank.samples(index), _bank.length(index));
+      set.swingReady = set.swingLoop.begin(set.swingPcm, HUM_XFADE);
+      set.swing.begin(set.hum, set.swingLoop);
+    }
+  }
+  if (!_humSets[0].humReady) {
+    log("hum %s missing in bank", humNames[0][0]);
+  }
+  return true;
+}
+
+
+// the platform starts calling mixStep() and audioStep() if this succeeds
+bool Saber::initAudio() {
+  return _hal.audio.begin(SABER_SAMPLE_RATE);
+}
+
+
+// called from loop(), the sound is started by the mixer task
+void Saber::playSound(uint8_t voice, Sound sound, uint16_t gain) {
+  if (!_audioRequests.push({voice, (uint8_t)sound, gain})) {
+    LOG_WARN("audio request queue full");
+  }
+}
+
+
+// mixer task only
+void Saber::startVoice(const AudioRequest &request) {
+  if (request.sound >= SOUND_COUNT) {
+    _mixer.stop(request.voice);
+    return;
+  }
+
+  if (request.sound == SOUND_HUM) {
+    uint8_t set = _profiles.current().humSet;
+    _activeHum = set < HUM_SETS && _humSets[set].humReady ? &_humSets[set] : &_humSets[0];
+    if (_activeHum->swingReady)
+      _mixer.play(request.voice, _activeHum->swing, request.gain, true);
+    else if (_activeHum->humReady)
+      _mixer.play(request.voice, _activeHum->hum, request.gain, true);
+    return;
+  }
+
+  int index = _soundIndex[request.sound];
+  if (index >= 0) {
+    _voicePcm[request.voice].begin(_bank.samples(index), _bank.length(index));
+    _mixer.play(request.voice, _voicePcm[request.voice], request.gain);
+  }
+}
+
+
+void Saber::mixStep() {
+  AudioRequest request;
+  uint32_t blocks = 0;
+
+  TRACE_BEGIN(TRACE_MIX, 0);
+  while (_audioRequests.pop(request)) {
+    startVoice(request);
+  }
+
+  // keep the ring topped up, silence is mixed as well
+  while (_pcmRing.space() >= SABER_I2S_BLOCK) {
+    _activeHum->swing.setSpeed(_motion.swingSpeed());
+    _mixer.mix(_mixBlock, SABER_I2S_BLOCK);
+    _envelope.process(_mixBlock, SABER_I2S_BLOCK);
+    _pcmRing.write(_mixBlock, SABER_I2S_BLOCK);
+    blocks++;
+  }
+  TRACE_END(TRACE_MIX, blocks);
+  TRACE_COUNTER(TRACE_PCM_FILL, _pcmRing.available());
+}
+
+
+void Saber::audioStep() {
+  size_t buffered = _pcmRing.available();
+  metrics.set(_pcmMetric, buffered);
+  metrics.min(_pcmLowMetric, buffered);
+
+  size_t n = _pcmRing.read(_i2sBlock, SABER_I2S_BLOCK);
+  if (n < SABER_I2S_BLOCK) {
+    _audioUnderruns++;
+    metrics.inc(_underrunsMetric);
+    TRACE_INSTANT(TRACE_UNDERRUN, SABER_I2S_BLOCK - n);
+    memset(_i2sBlock + n, 0, (SABER_I2S_BLOCK - n) * sizeof(int32_t));
+  }
+  TRACE_BEGIN(TRACE_I2S_WRITE, 0);
+  _hal.audio.write(_i2sBlock, SABER_I2S_BLOCK);
+  TRACE_END(TRACE_I2S_WRITE, 0);
+}
+
+
+void Saber::motionStep() {
+  MotionSample sample;
+  MotionEvent event;
+
+  TRACE_BEGIN(TRACE_MOTION, 0);
+  if (_hal.imu.read(sample) && _motion.update(sample, _hal.clock.millis(), event)) {
+    TRACE_INSTANT(TRACE_MOTION_EVENT, event.type);
+    _motionEvents.push(event);      // dropped if loop() is that far behind
+  }
+  TRACE_END(TRACE_MOTION, 0);
+}
+
+
+// replace the base and flicker layers and set the brightness of the
+// output, shows with the next frame
+void Saber::applyProfile() {
+  const Profile &profile = _profiles.current();
+  uint32_t now = _hal.clock.millis();
+
+  _leds.setBrightness(profile.brightness);
+  _effects.stopAll(EFFECT_BASE);
+  _effects.stopAll(EFFECT_FLICKER);
+  _effects.start({ EFFECT_BASE, profile.color, 0, 0, 0, 0 }, now);
+  if (profile.flicker != FLICKER_STEADY) {
+    uint8_t noise = profile.flicker == FLICKER_UNSTABLE ? 96 : 0;
+    _effects.start({ EFFECT_FLICKER, 0, 0, 0, 0, noise }, now);
+  }
+}
+
+
+void Saber::renderBlade() {
+  TRACE_BEGIN(TRACE_RENDER, 0);
+  _effects.render(_hal.clock.millis(), _bladeFrame, _leds.numPixels(), _blade.lit(), _envelope.level());
+  _leds.write(_bladeFrame, _leds.numPixels());
+  TRACE_END(TRACE_RENDER, 0);
+}
+
+
+// swing and clash sounds / flashes, only while the blade is on. A clash
+// with the button held down starts a lockup that lasts until the release.
+void Saber::handleMotion() {
+  MotionEvent event;
+
+  if (_effects.active(EFFECT_LOCKUP) && !_gestures.pressed())
+    _effects.stopAll(EFFECT_LOCKUP);
+
+  while (_motionEvents.pop(event)) {
+    if (!_blade.isOn())
+      continue;
+    if (event.type == MOTION_CLASH) {
+      playSound(VOICE_CLASH, SOUND_CLASH, _profiles.current().volume);
+      if (_gestures.pressed() && !_effects.active(EFFECT_LOCKUP)) {
+        uint16_t position = _blade.numPixels() * 2 / 3;
+        _effects.start({ EFFECT_LOCKUP, FLASH_COLOR, 0, position, LOCKUP_WIDTH, 0 }, _hal.clock.millis());
+      } else {
+        _effects.start({ EFFECT_CLASH, FLASH_COLOR, _cfg.clashFlashMs, 0, 0, 0 }, _hal.clock.millis());
+      }
+    } else {
+      playSound(VOICE_SWING, SOUND_SWING, _profiles.current().volume);
+    }
+  }
+}
+
+
+// click, turn the blade on
+void Saber::onClick() {
+  const Profile &profile = _profiles.current();
+  if (_igniteHook)
+    _igniteHook();
+  if (_blade.ignite(_hal.clock.millis(), _cfg.ignitionMs, (IgnitionCurve)profile.ignitionCurve)) {
+    LOG_INFO("turn on blade, profile %u", _profiles.index());
+    playSound(VOICE_POWER, SOUND_ON, profile.volume);
+    playSound(VOICE_HUM, SOUND_HUM, profile.volume);
+  }
+}
+
+// hold, turn the blade off. Not while a lockup runs: the button is held
+// down for it, the hold time passing is not a request to retract.
+void Saber::onHold() {
+  const Profile &profile = _profiles.current();
+  if (_effects.active(EFFECT_LOCKUP))
+    return;
+  if (_blade.retract(_hal.clock.millis(), _cfg.retractMs, (IgnitionCurve)profile.retractCurve)) {
+    LOG_INFO("turn off blade");
+    stopSound(VOICE_HUM);
+    playSound(VOICE_POWER, SOUND_OFF, profile.volume);
+  }
+}
+
+// double click / hold-click, switch to the next / previous profile. Color
+// and flicker follow with the next LED frame, a running hum is restarted
+// with the new set and volume.
+void Saber::switchProfile(uint8_t i) {
+  LOG_INFO("profile %u", i);
+  applyProfile();
+  if (_blade.isOn())
+    playSound(VOICE_HUM, SOUND_HUM, _profiles.current().volume);
+}
+
+// hold-click while the blade is on, deflect a blaster bolt somewhere on it
+void Saber::blaster() {
+  uint16_t position = random(_blade.numPixels() / 4, _blade.numPixels() * 3 / 4 + 1);
+  _effects.start({ EFFECT_BLASTER, FLASH_COLOR, BLASTER_TIME, position, BLASTER_WIDTH, 0 }, _hal.clock.millis());
+  playSound(VOICE_CLASH, SOUND_CLASH, _profiles.current().volume);
+}
+
+
+void Saber::handleButton() {
+  ButtonEdge edge;
+  Gesture gesture;
+
+  while (_hal.button.pop(edge)) {
+    TRACE_INSTANT(TRACE_BUTTON_EDGE, edge.pressed);
+    _gestures.edge(edge);
+  }
+  _gestures.update(_hal.clock.millis());
+
+  while (_gestures.pop(gesture)) {
+    TRACE_INSTANT(TRACE_GESTURE, gesture.type);
+    switch (gesture.type) {
+      case GESTURE_CLICK:        onClick(); break;
+      case GESTURE_HOLD:         onHold(); break;
+      case GESTURE_DOUBLE_CLICK: switchProfile(_profiles.next()); break;
+      case GESTURE_HOLD_CLICK:
+        if (_blade.isOn())
+          blaster();
+        else
+          switchProfile(_profiles.previous());
+        break;
+    }
+  }
+}
+
+
+void Saber::loop() {
+  TRACE_BEGIN(TRACE_LOOP, 0);
+
+  // decode the edges queued by the button interrupt
+  handleButton();
+
+  handleMotion();
+
+  // advance ignition / retraction and follow the audio. The frame is only
+  // composed when the renderer takes one, which only pushes it if
+  // something changed
+  uint32_t now = _hal.clock.micros();
+  if (_blade.update(_hal.clock.millis()))
+    _bladeChanged = true;
+  if ((_bladeChanged || !_blade.isOff()) && _leds.due(now)) {
+    renderBlade();
+    _bladeChanged = false;
+  }
+  TRACE_BEGIN(TRACE_LED_SHOW, 0);
+  bool sent = _leds.render(now);
+  TRACE_END(TRACE_LED_SHOW, sent);
+  metrics.set(_framesMetric, _leds.framesRendered());
+  metrics.set(_skippedMetric, _leds.framesSkipped());
+  metrics.inc(_loopsMetric);
+
+  // report new underruns at most once a second
+  uint32_t underruns = audioUnderruns();
+  if (underruns != _reportedUnderruns && _hal.clock.millis() - _lastReport > 1000) {
+    LOG_WARN("audio underruns %u", underruns);
+    _reportedUnderruns = underruns;
+    _lastReport = _hal.clock.millis();
+  }
+  TRACE_END(TRACE_LOOP, 0);
+}
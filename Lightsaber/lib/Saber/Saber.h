@@ -0,0 +1,197 @@
+#ifndef Saber_h
+#define Saber_h
+
+#include <atomic>
+#include <stdint.h>
+
+#include "Hal.h"
+#include "MotionSensor.h"
+#include "MotionDetector.h"
+#include "SpscRing.h"
+#include "Blade.h"
+#include "MemoryPcm.h"
+#include "HumLoop.h"
+#include "SmoothSwing.h"
+#include "Mixer.h"
+#include "Envelope.h"
+#include "SoundBank.h"
+#include "LedRenderer.h"
+#include "EffectEngine.h"
+#include "MultiStrip.h"
+#include "SaberConfig.h"
+#include "ProfileTable.h"
+#include "GestureRecognizer.h"
+#include "Metrics.h"
+
+#define SABER_SAMPLE_RATE  16000
+#define SABER_AUDIO_RING   1024   // I2S samples between mixer and I2S (64ms)
+#define SABER_I2S_BLOCK    256    // samples per I2S write
+#define SABER_MAX_FPS      100    // upper limit for strip updates per second
+#define SABER_MOTION_PERIOD 2     // ms between IMU samples (500 Hz)
+#define SABER_MOTION_EVENTS 16
+#define SABER_AUDIO_REQUESTS 16
+
+// fixed voice assignment, sounds on different voices layer
+#define VOICE_HUM    0
+#define VOICE_POWER  1            // on / off
+#define VOICE_SWING  2
+#define VOICE_CLASH  3
+
+// profiles pick a hum set by index
+#define HUM_XFADE 512             // samples crossfaded at the loop point
+#define HUM_SETS  2
+
+// everything the saber runs on, see Hal.h
+struct SaberHal {
+  Clock &clock;
+  FileSystem &fs;
+  AudioSink &audio;
+  LedStrip *strips[STRIP_MAX];    // nullptr past the strips fitted
+  ButtonSource &button;
+  MotionSensor &imu;
+  void (*print)(const char *line);
+};
+
+//
+// The saber firmware without the hardware.
+//
+// Holds the blade, effects, LED pipeline, mixer, profiles and gestures and
+// the glue between them. The platform provides the SaberHal and the
+// threads: loop() on the main task, motionStep() every
+// SABER_MOTION_PERIOD ms, mixStep() and audioStep() on the audio core. On
+// the ESP32 these are FreeRTOS tasks, on the host they are called in turn
+// against a virtual clock.
+//
+// Boot messages go straight to SaberHal::print, everything logged from
+// the running tasks is deferred (Log.h) and drained by the platform.
+// Loop rate, PCM ring fill, underruns and LED frames are kept in the
+// metrics registry (Metrics.h), the platform adds heap and stacks.
+//
+// The init*() steps are the boot phases, the platform runs them through its
+// BootSequencer. Sound bank and audio may come up lazily, setIgniteHook()
+// is called before every ignition to bring them in.
+//
+class Saber {
+  public:
+    Saber(const SaberHal &hal);
+
+    // boot phases
+    bool initConfig();
+    bool initButton();
+    bool initStrip();
+    bool initMotion();
+    bool initSoundBank();
+    bool initAudio();
+
+    void setIgniteHook(void (*hook)()) { _igniteHook = hook; }
+
+    // main task: button, motion events, blade and LEDs
+    void loop();
+    // motion task: one IMU sample
+    void motionStep();
+    // mixer task: start requested sounds and keep the PCM ring topped up
+    void mixStep();
+    // I2S task: move one block from the ring into the sink, silence on
+    // underrun. Run mixStep() once before the first call, an empty ring
+    // would count as an underrun.
+    void audioStep();
+
+    const SaberConfig &config() const { return _cfg; }
+    const Blade &blade() const { return _blade; }
+    const LedRenderer &leds() const { return _leds; }
+    const EffectEngine &effects() const { return _effects; }
+    const ProfileTable &profiles() const { return _profiles; }
+    uint32_t audioUnderruns() const { return _audioUnderruns.load(std::memory_order_relaxed); }
+    size_t audioBuffered() const { return _pcmRing.available(); }
+
+  private:
+    // Sounds come pre-decoded from the sound bank, their bank index is
+    // looked up once at boot. SOUND_HUM plays the hum set of the profile.
+    enum Sound {
+      SOUND_ON,
+      SOUND_OFF,
+      SOUND_HUM,
+      SOUND_SWING,
+      SOUND_CLASH,
+      SOUND_COUNT
+    };
+
+    // play request from loop() to the mixer task, SOUND_COUNT stops the voice
+    struct AudioRequest {
+      uint8_t voice;
+      uint8_t sound;
+      uint16_t gain;
+    };
+
+    struct HumSet {
+      MemoryPcm humPcm;
+      HumLoop hum;
+      bool humReady = false;
+      MemoryPcm swingPcm;
+      HumLoop swingLoop;
+      SmoothSwing swing;
+      bool swingReady = false;
+    };
+
+    bool loadJsonConfig();
+    void applyProfile();
+    void renderBlade();
+    void handleMotion();
+    void handleButton();
+    void onClick();
+    void onHold();
+    void switchProfile(uint8_t i);
+    void blaster();
+    void playSound(uint8_t voice, Sound sound, uint16_t gain = MIXER_UNITY);
+    void stopSound(uint8_t voice) { playSound(voice, SOUND_COUNT); }
+    void startVoice(const AudioRequest &request);
+    uint32_t random(uint32_t low, uint32_t high);
+    void log(const char *format, ...);
+
+    SaberHal _hal;
+    SaberConfig _cfg;
+    void (*_igniteHook)() = nullptr;
+
+    // motion task -> loop()
+    MotionDetector _motion;
+    SpscRing<MotionEvent, SABER_MOTION_EVENTS> _motionEvents;
+
+    // audio, the ring is written by the mixer task and read by the I2S task
+    SpscRing<int32_t, SABER_AUDIO_RING> _pcmRing;
+    SpscRing<AudioRequest, SABER_AUDIO_REQUESTS> _audioRequests;
+    std::atomic<uint32_t> _audioUnderruns;
+    Mixer _mixer;
+    Envelope _envelope;           // level of the mixed audio, drives the blade brightness
+    SoundBank _bank;
+    int _soundIndex[SOUND_COUNT]; // bank index, -1 if missing
+    MemoryPcm _voicePcm[MIXER_VOICES];
+    HumSet _humSets[HUM_SETS];
+    HumSet *_activeHum;           // mixer task only
+    int32_t _mixBlock[SABER_I2S_BLOCK];
+    int32_t _i2sBlock[SABER_I2S_BLOCK];
+
+    ProfileTable _profiles;
+    GestureRecognizer _gestures;
+
+    SegmentMap _segments;
+    MultiStrip _output;
+    LedRenderer _leds;
+    Blade _blade;
+    EffectEngine _effects;
+    uint32_t _bladeFrame[LED_MAX_PIXELS];
+    bool _bladeChanged = true;    // lit changed since the last composed frame
+
+    // metric ids
+    int _loopsMetric;
+    int _pcmMetric;
+    int _pcmLowMetric;
+    int _underrunsMetric;
+    int _framesMetric;
+    int _skippedMetric;
+
+    uint32_t _random = 0;
+    uint32_t _reportedUnderruns = 0;
+    uint32_t _lastReport = 0;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SaberTrace_h
+#define SaberTrace_h
+
+#include "Trace.h"
+
+// trace event ids of the saber, names in saberTraceNames for the dump
+enum SaberTraceId : uint16_t {
+  TRACE_LOOP,             // begin / end of loop()
+  TRACE_BUTTON_EDGE,      // arg pressed
+  TRACE_GESTURE,          // arg GestureType
+  TRACE_MOTION,           // begin / end of motionStep()
+  TRACE_MOTION_EVENT,     // arg MotionEventType
+  TRACE_RENDER,           // effects into the frame
+  TRACE_LED_SHOW,         // LedRenderer::render(), end arg 1 if a frame was sent
+  TRACE_MIX,              // begin / end of mixStep(), end arg blocks mixed
+  TRACE_PCM_FILL,         // counter, samples in the PCM ring
+  TRACE_I2S_WRITE,        // one block into the sink
+  TRACE_UNDERRUN,         // arg samples that were missing
+  TRACE_IDS
+};
+
+extern const char *const saberTraceNames[TRACE_IDS];
+
+#endif
@@ -0,0 +1,158 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ArduinoJson.h>
+
+#include "SaberConfig.h"
+#include "IgnitionCurve.h"
+#include "SegmentMap.h"
+#include "LedRenderer.h"
+
+
+void configDefaults(SaberConfig &cfg) {
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.color = 0x0000ff;
+  cfg.brightness = 20;
+  cfg.soundProfile = 0;
+  cfg.numPixels = 50;
+  cfg.ignitionMs = 980;     // length of on.wav
+  cfg.retractMs = 930;      // length of off.wav
+  cfg.ignitionCurve = CURVE_SQRT;
+  cfg.retractCurve = CURVE_SQRT;
+  cfg.clashFlashMs = 60;
+  cfg.strips = 1;
+  cfg.stripMode = SEGMENT_MIRRORED;
+  cfg.stripPins[0] = 9;
+  cfg.powerBudgetMa = 2000;
+  configSeal(cfg);
+}
+
+
+void configSeal(SaberConfig &cfg) {
+  cfg.magic = CONFIG_MAGIC;
+  cfg.version = CONFIG_VERSION;
+  cfg.size = sizeof(SaberConfig);
+  cfg.crc = crc32(&cfg, offsetof(SaberConfig, crc));
+}
+
+
+bool configCheck(const SaberConfig &cfg) {
+  return cfg.magic == CONFIG_MAGIC && cfg.version == CONFIG_VERSION &&
+         cfg.size == sizeof(SaberConfig) &&
+         cfg.crc == crc32(&cfg, offsetof(SaberConfig, crc));
+}
+
+
+// a number clamped to min..max, anything else keeps the field as is
+template <typename T>
+static void jsonNumber(JsonVariantConst value, long min, long max, T &field) {
+  if (!value.is<double>())
+    return;
+  double v = value.as<double>();
+  field = v < min ? min : v > max ? max : (long)v;
+}
+
+
+bool configFromJson(char *json, size_t length, SaberConfig &cfg, const char **unknown) {
+  configDefaults(cfg);
+  // the strings stay in json, the document only holds the tree
+  StaticJsonDocument<CONFIG_JSON_MAX> doc;
+  if (deserializeJson(doc, json, length) || !doc.is<JsonObject>())
+    return false;
+
+  const JsonDocument &root = doc;
+  const char *name = root["color"];
+  if (name && !configColor(name, cfg.color) && unknown)
+    *unknown = "color";
+  name = root["ignitionCurve"];
+  if (name && !configCurve(name, cfg.ignitionCurve) && unknown)
+    *unknown = "ignitionCurve";
+  name = root["retractCurve"];
+  if (name && !configCurve(name, cfg.retractCurve) && unknown)
+    *unknown = "retractCurve";
+  name = root["stripMode"];
+  if (name && !configStripMode(name, cfg.stripMode) && unknown)
+    *unknown = "stripMode";
+
+  jsonNumber(root["brightness"], 0, 255, cfg.brightness);
+  jsonNumber(root["soundProfile"], 0, 255, cfg.soundProfile);
+  jsonNumber(root["bladeLength"], 0, LED_MAX_PIXELS, cfg.numPixels);
+  jsonNumber(root["ignitionMs"], 0, 65535, cfg.ignitionMs);
+  jsonNumber(root["retractMs"], 0, 65535, cfg.retractMs);
+  jsonNumber(root["clashFlashMs"], 0, 65535, cfg.clashFlashMs);
+  jsonNumber(root["powerBudgetMa"], 0, 65535, cfg.powerBudgetMa);
+  jsonNumber(root["strips"], 1, STRIP_MAX, cfg.strips);
+  for (int i = 0; i < STRIP_MAX; i++) {
+    jsonNumber(root["stripPins"][i], 0, 39, cfg.stripPins[i]);
+    if (root["stripReversed"][i].as<bool>())
+      cfg.stripReversed |= 1 << i;
+  }
+  configSeal(cfg);
+  return true;
+}
+
+
+bool configColor(const char *name, uint32_t &color) {
+  static const struct { const char *name; uint32_t color; } colors[] = {
+    { "red",    0xff0000 },
+    { "green",  0x00ff00 },
+    { "blue",   0x0000ff },
+    { "white",  0xffffff },
+    { "yellow", 0xffc000 },
+    { "orange", 0xff4000 },
+    { "cyan",   0x00ffff },
+    { "purple", 0x8000ff },
+  };
+
+  if (name[0] == '#') {
+    char *end;
+    unsigned long value = strtoul(name + 1, &end, 16);
+    if (end - name != 7 || *end != 0)
+      return false;
+    color = value;
+    return true;
+  }
+  for (const auto &c : colors) {
+    if (strcmp(name, c.name) == 0) {
+      color = c.color;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool configCurve(const char *name, uint8_t &curve) {
+  static const char *names[CURVE_COUNT] = { "sqrt", "ease", "bounce", "flicker" };
+
+  for (uint8_t i = 0; i < CURVE_COUNT; i++) {
+    if (strcmp(name, names[i]) == 0) {
+      curve = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool configStripMode(const char *name, uint8_t &mode) {
+  if (strcmp(name, "mirrored") == 0)
+    mode = SEGMENT_MIRRORED;
+  else if (strcmp(name, "independent") == 0)
+    mode = SEGMENT_INDEPENDENT;
+  else
+    return false;
+  return true;
+}
+
+
+uint32_t crc32(const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t crc = 0xffffffff;
+
+  while (len--) {
+    crc ^= *p++;
+    for (int bit = 0; bit < 8; bit++)
+      crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+  }
+  return ~crc;
+}
@@ -0,0 +1,74 @@
+#ifndef SaberConfig_h
+#define SaberConfig_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Binary saber configuration.
+//
+// The blob is the struct itself, written by tools/config from config.json
+// and flashed to the config partition. Loading is one flash read into a
+// SaberConfig followed by configCheck(), nothing is parsed on the device.
+// All fields are naturally aligned little endian, the layout is fixed by
+// the static_assert below; bump CONFIG_VERSION when it changes.
+//
+#define CONFIG_MAGIC    0x47464353    // "SCFG"
+#define CONFIG_VERSION  3
+
+struct SaberConfig {
+  uint32_t magic;          // CONFIG_MAGIC
+  uint16_t version;        // CONFIG_VERSION
+  uint16_t size;           // sizeof(SaberConfig)
+  uint32_t color;          // blade color 0x00RRGGBB at full scale
+  uint8_t brightness;      // 0..255
+  uint8_t soundProfile;    // hum set of the config profile, the rest of it is above
+  uint16_t numPixels;      // blade length in pixels, the frame the strips show
+  uint16_t ignitionMs;
+  uint16_t retractMs;
+  uint8_t ignitionCurve;   // IgnitionCurve
+  uint8_t retractCurve;
+  uint16_t clashFlashMs;   // time the blade flashes white on a clash
+  uint8_t strips;          // 1..STRIP_MAX strips driven in parallel
+  uint8_t stripMode;       // SegmentMode
+  uint8_t stripPins[4];    // data pin per strip
+  uint8_t stripReversed;   // bit per strip, the strip runs tip to hilt
+  uint8_t reserved;
+  uint16_t powerBudgetMa;  // strip current limit, 0 = unlimited
+  uint16_t reserved2;
+  uint32_t crc;            // crc32 of all bytes before this field
+};
+
+static_assert(sizeof(SaberConfig) == 40, "SaberConfig layout changed, bump CONFIG_VERSION");
+
+// fill in the defaults, which are also used for keys missing in the json
+void configDefaults(SaberConfig &cfg);
+
+// set magic, version, size and crc, call after changing any field
+void configSeal(SaberConfig &cfg);
+
+// true if the blob is a config of this version with a matching crc
+bool configCheck(const SaberConfig &cfg);
+
+// color by name ("blue", "red", ...) or as "#rrggbb", false if unknown
+bool configColor(const char *name, uint32_t &color);
+
+// config.json as the tool and the firmware fallback read it, parsed in
+// place. Missing keys keep their default, numbers are truncated and
+// clamped to their field, values of the wrong type are ignored. A color,
+// curve or strip mode that is not known keeps the default, its key is
+// returned in unknown. The result is sealed. False if the text is no json.
+// The firmware reads at most CONFIG_JSON_MAX bytes of config.json.
+#define CONFIG_JSON_MAX 1024
+bool configFromJson(char *json, size_t length, SaberConfig &cfg, const char **unknown = nullptr);
+
+// strip mode by name ("mirrored", "independent"), false if unknown
+bool configStripMode(const char *name, uint8_t &mode);
+
+// ignition curve by name ("sqrt", "ease", "bounce", "flicker"), false if unknown
+bool configCurve(const char *name, uint8_t &curve);
+
+// standard crc32 (zlib polynomial)
+uint32_t crc32(const void *data, size_t len);
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <chrono>
+
+#include "Simulation.h"
+#include "Log.h"
+
+
+// Saber prints through a plain function, it goes to the current simulation
+static Simulation *current = nullptr;
+
+static std::vector<MotionSample> motionTrace() {
+  std::vector<MotionSample> trace;
+  for (uint32_t t = 0; t < 10000; t += SABER_MOTION_PERIOD) {
+    MotionSample s = { 0, 0, MOTION_ACCEL_1G, 0, 0, 0 };
+    uint32_t phase = t % 2000;
+    if (phase >= 1000 && phase < 1300)
+      s.gz = (int16_t)(phase < 1150 ? (phase - 1000) * 60 : (1300 - phase) * 60);
+    if (t >= 4500 && t < 4504)
+      s.ax = 4 * MOTION_ACCEL_1G;
+    trace.push_back(s);
+  }
+  return trace;
+}
+
+
+Simulation::Simulation(const char *dataDir, const char *wavPath, bool quiet)
+  : button(clock), _fs(dataDir), _audio(wavPath), _trace(motionTrace()),
+    _imu(_trace.data(), _trace.size(), true),
+    _saber({ clock, _fs, _audio, { &strips[0], &strips[1], &strips[2], &strips[3] },
+             button, _imu, print }),
+    _quiet(quiet) {
+  current = this;
+}
+
+
+Simulation::~Simulation() {
+  if (current == this)
+    current = nullptr;
+}
+
+
+void Simulation::print(const char *line) {
+  if (current == nullptr || current->_quiet)
+    return;
+  printf("[%8.3f] %s\n", current->clock.now() / 1e6, line);
+}
+
+
+bool Simulation::begin() {
+  logBuffer.begin([]() -> uint32_t { return current ? current->clock.millis() : 0; });
+  bool ok = _saber.initConfig();
+  _saber.initButton();
+  ok = _saber.initStrip() && ok;
+  _motionReady = _saber.initMotion();
+  _audioReady = _saber.initSoundBank() && _saber.initAudio();
+  return ok;
+}
+
+
+static uint32_t since(std::chrono::steady_clock::time_point start) {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+StepTimes Simulation::step() {
+  const uint32_t blockMs = SABER_I2S_BLOCK * 1000 / SABER_SAMPLE_RATE;
+  StepTimes times = { 0, 0, 0, 0 };
+
+  clock.advance(1000);
+  if (_motionReady && _ms % SABER_MOTION_PERIOD == 0) {
+    auto start = std::chrono::steady_clock::now();
+    _saber.motionStep();
+    times.motionNs = since(start);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  _saber.loop();
+  times.loopNs = since(start);
+
+  if (_audioReady) {
+    start = std::chrono::steady_clock::now();
+    _saber.mixStep();
+    times.mixNs = since(start);
+    if (_ms % blockMs == 0) {
+      start = std::chrono::steady_clock::now();
+      _saber.audioStep();
+      times.audioNs = since(start);
+    }
+  }
+  // the log task, outside the timed part
+  logBuffer.drain(print);
+  _ms++;
+  return times;
+}
+
+
+void Simulation::run(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++)
+    step();
+}
+
+#endif
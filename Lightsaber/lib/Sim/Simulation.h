@@ -0,0 +1,64 @@
+#ifndef Simulation_h
+#define Simulation_h
+
+#include <stdint.h>
+#include <vector>
+
+#include "Saber.h"
+#include "NativeHal.h"
+#include "TraceSensor.h"
+
+// host CPU time of the tasks in one step, 0 if the task did not run
+struct StepTimes {
+  uint32_t loopNs;
+  uint32_t motionNs;
+  uint32_t mixNs;
+  uint32_t audioNs;
+};
+
+//
+// The saber on the host HAL, stepped in 1 ms of virtual time.
+//
+// Each step runs the tasks the way they are scheduled on the ESP32: the
+// motion task every SABER_MOTION_PERIOD ms, loop(), the mixer, and the I2S
+// sink whenever a block has been played out. Everything is driven by the
+// virtual clock and the button script, so two runs see the same inputs.
+// Deferred log records are drained after every step, undecoded.
+// The IMU replays a synthetic trace: at rest, one swing every 2 s and a
+// clash at 4.5 s of every 10 s.
+//
+class Simulation {
+  public:
+    // dataDir holds config.json and the partitions config.bin and
+    // soundbank.bin, wavPath nullptr discards the audio
+    Simulation(const char *dataDir, const char *wavPath = nullptr, bool quiet = false);
+    ~Simulation();
+
+    // all boot phases, eager, false if config or strips failed
+    bool begin();
+
+    // one ms, returns the host time each task took
+    StepTimes step();
+    void run(uint32_t ms);
+
+    VirtualClock clock;
+    ScriptedButton button;
+    MemoryStrip strips[STRIP_MAX];
+    Saber &saber() { return _saber; }
+    WavSink &audio() { return _audio; }
+
+  private:
+    static void print(const char *line);
+
+    DirFileSystem _fs;
+    WavSink _audio;
+    std::vector<MotionSample> _trace;
+    TraceSensor _imu;
+    Saber _saber;
+    bool _quiet;
+    bool _motionReady = false;
+    bool _audioReady = false;
+    uint32_t _ms = 0;
+};
+
+#endif
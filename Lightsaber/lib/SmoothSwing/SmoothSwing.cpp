@@ -0,0 +1,104 @@
+#include "SmoothSwing.h"
+
+#define GAIN_STEPS 64
+
+namespace {
+
+constexpr double sqrtc(double x) {
+  double r = x > 1 ? x : 1;
+  for (int i = 0; i < 32; i++)
+    r = 0.5 * (r + x / r);
+  return r;
+}
+
+// equal power crossfade: gain of loop B for a swing amount of i / GAIN_STEPS,
+// loop A uses the table backwards
+struct GainTable {
+  int16_t v[GAIN_STEPS + 1];
+};
+
+constexpr GainTable makeGains() {
+  GainTable t{};
+  for (int i = 0; i <= GAIN_STEPS; i++)
+    t.v[i] = (int16_t)(sqrtc((double)i / GAIN_STEPS) * 32767 + 0.5);
+  return t;
+}
+
+constexpr GainTable gains = makeGains();
+
+}
+
+
+void SmoothSwing::begin(PcmSource &a, PcmSource &b) {
+  _a.source = &a;
+  _b.source = &b;
+  seek(0);
+}
+
+
+bool SmoothSwing::seek(uint32_t sample) {
+  if (_a.source == nullptr)
+    return false;
+  Loop *loops[2] = { &_a, &_b };
+  for (Loop *loop : loops) {
+    if (!loop->source->seek(sample) || loop->source->read(loop->in, 2) != 2)
+      return false;
+    loop->phase = 0;
+  }
+  _a.gain = gains.v[GAIN_STEPS];
+  _b.gain = 0;
+  return true;
+}
+
+
+// resample count samples of one loop at step (Q16) and add them to _acc,
+// the gain is ramped from the previous block's gain to the new one
+void SmoothSwing::render(Loop &loop, uint32_t step, int32_t gain, size_t count) {
+  uint32_t end = loop.phase + count * step;
+  size_t advance = end >> 16;
+
+  // in[0], in[1] are carried over, the last output needs in[advance + 1]
+  size_t got = loop.source->read(loop.in + 2, advance);
+  for (size_t i = got; i < advance; i++)
+    loop.in[2 + i] = 0;
+
+  int32_t g = loop.gain << 8;                          // Q23 for a smooth ramp
+  int32_t dg = ((gain - loop.gain) << 8) / (int32_t)count;
+  uint32_t pos = loop.phase;
+  for (size_t k = 0; k < count; k++) {
+    int32_t a = loop.in[pos >> 16];
+    int32_t b = loop.in[(pos >> 16) + 1];
+    int32_t s = a + (((b - a) * (int32_t)(pos & 0xffff)) >> 16);
+    _acc[k] += (s * (g >> 8)) >> 15;
+    g += dg;
+    pos += step;
+  }
+
+  loop.in[0] = loop.in[advance];
+  loop.in[1] = loop.in[advance + 1];
+  loop.phase = end & 0xffff;
+  loop.gain = gain;
+}
+
+
+size_t SmoothSwing::read(int16_t *data, size_t count) {
+  if (_a.source == nullptr)
+    return 0;
+  if (count > SWING_BLOCK)
+    count = SWING_BLOCK;
+
+  uint32_t speed = _speed > SWING_MAX_SPEED ? SWING_MAX_SPEED : _speed;
+  uint32_t amount = speed * GAIN_STEPS / SWING_MAX_SPEED;     // 0..GAIN_STEPS
+  uint32_t step = 65536 + speed * SWING_MAX_PITCH / SWING_MAX_SPEED;
+
+  for (size_t i = 0; i < count; i++)
+    _acc[i] = 0;
+  render(_a, step, gains.v[GAIN_STEPS - amount], count);
+  render(_b, step, gains.v[amount], count);
+
+  for (size_t i = 0; i < count; i++) {
+    int32_t s = _acc[i];
+    data[i] = (int16_t)(s > 32767 ? 32767 : s < -32768 ? -32768 : s);
+  }
+  return count;
+}
@@ -0,0 +1,47 @@
+#ifndef SmoothSwing_h
+#define SmoothSwing_h
+
+#include "PcmSource.h"
+
+#define SWING_BLOCK      256     // max samples per read()
+#define SWING_MAX_SPEED  600     // deg/s for the full effect
+#define SWING_MAX_PITCH  9830    // pitch raise at full speed, Q16 (+15%)
+
+//
+// Smooth swing hum: two endless hum loops played at the same time.
+//
+// The swing speed crossfades from loop A (the resting hum) to loop B (the
+// swing hum) with equal power gains and raises the pitch of both. Pitch is
+// done by linear interpolation with a Q16 phase, gains come from a constexpr
+// table and are ramped across each block, so there are no zipper noises and
+// no floating point in the audio task.
+//
+class SmoothSwing : public PcmSource {
+  public:
+    // both sources must never run dry, e.g. HumLoop
+    void begin(PcmSource &a, PcmSource &b);
+
+    // deg/s, takes effect with the next block
+    void setSpeed(uint16_t speed) { _speed = speed; }
+
+    size_t read(int16_t *data, size_t count) override;
+    bool seek(uint32_t sample) override;
+    uint32_t length() const override { return _a.source ? _a.source->length() : 0; }
+
+  private:
+    struct Loop {
+      PcmSource *source = nullptr;
+      int16_t in[SWING_BLOCK * 2 + 2];   // two history samples + new input
+      uint32_t phase = 0;                // Q16 position after in[0]
+      int32_t gain = 0;                  // Q15, gain at the end of the last block
+    };
+
+    void render(Loop &loop, uint32_t step, int32_t gain, size_t count);
+
+    Loop _a;
+    Loop _b;
+    uint16_t _speed = 0;
+    int32_t _acc[SWING_BLOCK];
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include <string.h>
+
+#include "SoundBank.h"
+
+
+bool SoundBank::begin(const uint8_t *image, size_t size) {
+  _image = nullptr;
+  _header = nullptr;
+  _entries = nullptr;
+
+  if (image == nullptr || size < SOUNDBANK_DATA_START)
+    return false;
+
+  const SoundBankHeader *header = (const SoundBankHeader *)image;
+  if (header->magic != SOUNDBANK_MAGIC || header->version != SOUNDBANK_VERSION)
+    return false;
+  if (header->count > SOUNDBANK_MAX_SOUNDS || header->size > size)
+    return false;
+
+  // every payload has to be aligned and inside the image
+  const SoundBankEntry *entries = (const SoundBankEntry *)(image + sizeof(SoundBankHeader));
+  for (uint16_t i = 0; i < header->count; i++) {
+    const SoundBankEntry &e = entries[i];
+    if (e.offset % SOUNDBANK_ALIGN != 0 || e.offset < SOUNDBANK_DATA_START)
+      return false;
+    if (e.offset > header->size || e.length > (header->size - e.offset) / 2)
+      return false;
+    if (memchr(e.name, 0, SOUNDBANK_NAME_LEN) == nullptr)
+      return false;
+  }
+
+  _image = image;
+  _header = header;
+  _entries = entries;
+  return true;
+}
+
+
+int SoundBank::find(const char *name) const {
+  for (uint16_t i = 0; i < count(); i++) {
+    if (strcmp(_entries[i].name, name) == 0)
+      return i;
+  }
+  return -1;
+}
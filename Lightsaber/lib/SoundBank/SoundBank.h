@@ -0,0 +1,70 @@
+#ifndef SoundBank_h
+#define SoundBank_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Sound bank: all sounds of the saber pre-decoded into one image.
+//
+// Layout (little endian):
+//   SoundBankHeader
+//   SoundBankEntry[SOUNDBANK_MAX_SOUNDS]     fixed size index table
+//   payloads                                 mono 16 bit PCM, each aligned
+//                                            to SOUNDBANK_ALIGN bytes
+//
+// The image is written by tools/soundbank on the host and flashed to the
+// "soundbank" data partition, which is memory mapped at boot. Playing a
+// sound is then just an index into the table, no file system, no header
+// parsing and no decoding.
+//
+#define SOUNDBANK_MAGIC       0x4b4e4253   // "SBNK"
+#define SOUNDBANK_VERSION     1
+#define SOUNDBANK_MAX_SOUNDS  32
+#define SOUNDBANK_NAME_LEN    16
+#define SOUNDBANK_ALIGN       16
+
+struct SoundBankHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;         // used entries
+  uint32_t sampleRate;
+  uint32_t size;          // total image size in bytes
+};
+
+struct SoundBankEntry {
+  char name[SOUNDBANK_NAME_LEN];   // zero terminated
+  uint32_t offset;                 // payload offset from the image start
+  uint32_t length;                 // samples
+  uint32_t reserved[2];
+};
+
+static_assert(sizeof(SoundBankHeader) == 16, "unexpected SoundBankHeader layout");
+static_assert(sizeof(SoundBankEntry) == 32, "unexpected SoundBankEntry layout");
+
+#define SOUNDBANK_DATA_START (sizeof(SoundBankHeader) + SOUNDBANK_MAX_SOUNDS * sizeof(SoundBankEntry))
+
+
+class SoundBank {
+  public:
+    // validate an image in memory (memory mapped partition or host buffer)
+    bool begin(const uint8_t *image, size_t size);
+
+    // index of the named sound, -1 if missing. Meant for setup(), play by index.
+    int find(const char *name) const;
+
+    uint16_t count() const { return _header ? _header->count : 0; }
+    uint32_t sampleRate() const { return _header ? _header->sampleRate : 0; }
+    const char *name(int index) const { return _entries[index].name; }
+
+    // O(1) access to a sound's samples, index must be valid
+    const int16_t *samples(int index) const { return (const int16_t *)(_image + _entries[index].offset); }
+    uint32_t length(int index) const { return _entries[index].length; }
+
+  private:
+    const uint8_t *_image = nullptr;
+    const SoundBankHeader *_header = nullptr;
+    const SoundBankEntry *_entries = nullptr;
+};
+
+#endif
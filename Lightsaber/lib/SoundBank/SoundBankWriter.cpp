@@ -0,0 +1,129 @@
+#ifndef ARDUINO
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "SoundBankWriter.h"
+#include "WavReader.h"
+
+#define SINC_TAPS  16      // taps on each side of the resampling filter
+
+
+class StdioSource : public ByteSource {
+  public:
+    ~StdioSource() { if (f) fclose(f); }
+    bool open(const char *path) { f = fopen(path, "rb"); return f != nullptr; }
+    size_t read(uint8_t *data, size_t len) override { return fread(data, 1, len, f); }
+    bool seek(uint32_t pos) override { return fseek(f, pos, SEEK_SET) == 0; }
+    uint32_t size() override {
+      long pos = ftell(f);
+      fseek(f, 0, SEEK_END);
+      long size = ftell(f);
+      fseek(f, pos, SEEK_SET);
+      return size;
+    }
+  private:
+    FILE *f = nullptr;
+};
+
+
+std::vector<int16_t> soundBankResample(const std::vector<int16_t> &in, uint32_t from, uint32_t to) {
+  if (from == to)
+    return in;
+
+  double ratio = (double)from / to;
+  double cutoff = 0.95 * (from < to ? 1.0 : 1.0 / ratio);   // relative to the input rate
+  size_t count = (size_t)(in.size() / ratio);
+  std::vector<int16_t> out(count);
+
+  for (size_t i = 0; i < count; i++) {
+    double center = i * ratio;
+    long first = (long)floor(center) - SINC_TAPS / cutoff;
+    long last = (long)ceil(center) + SINC_TAPS / cutoff;
+    double acc = 0, norm = 0;
+    for (long k = first; k <= last; k++) {
+      double x = (k - center) * cutoff;
+      if (fabs(x) >= SINC_TAPS)
+        continue;
+      double sinc = x == 0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+      double w = sinc * (0.5 + 0.5 * cos(M_PI * x / SINC_TAPS));
+      norm += w;
+      if (k >= 0 && k < (long)in.size())
+        acc += w * in[k];
+    }
+    long v = lround(acc / norm);
+    out[i] = (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+  }
+  return out;
+}
+
+
+std::string soundBankName(const std::string &path) {
+  std::string name = path;
+  size_t slash = name.find_last_of('/');
+  if (slash != std::string::npos)
+    name = name.substr(slash + 1);
+  if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0)
+    name.resize(name.size() - 4);
+  return name;
+}
+
+
+static bool loadWav(const std::string &path, std::vector<int16_t> &pcm, std::string &error) {
+  StdioSource source;
+  WavReader wav;
+  if (!source.open(path.c_str()) || !wav.begin(source)) {
+    error = path + ": not a 16 bit PCM wav file";
+    return false;
+  }
+  std::vector<int16_t> raw(wav.length());
+  if (wav.read(raw.data(), raw.size()) != raw.size()) {
+    error = path + ": short read";
+    return false;
+  }
+  pcm = soundBankResample(raw, wav.sampleRate(), SOUNDBANK_RATE);
+  return true;
+}
+
+
+bool soundBankPack(const std::vector<std::string> &files, std::vector<uint8_t> &image, std::string &error) {
+  image.clear();
+  if (files.size() > SOUNDBANK_MAX_SOUNDS) {
+    error = "at most " + std::to_string(SOUNDBANK_MAX_SOUNDS) + " sounds fit into a bank";
+    return false;
+  }
+
+  std::vector<uint8_t> out(SOUNDBANK_DATA_START, 0);
+  for (size_t i = 0; i < files.size(); i++) {
+    std::string name = soundBankName(files[i]);
+    if (name.size() >= SOUNDBANK_NAME_LEN) {
+      error = files[i] + ": name longer than " + std::to_string(SOUNDBANK_NAME_LEN - 1) + " characters";
+      return false;
+    }
+    std::vector<int16_t> pcm;
+    if (!loadWav(files[i], pcm, error))
+      return false;
+
+    size_t offset = (out.size() + SOUNDBANK_ALIGN - 1) & ~(size_t)(SOUNDBANK_ALIGN - 1);
+    out.resize(offset + pcm.size() * 2, 0);
+    memcpy(out.data() + offset, pcm.data(), pcm.size() * 2);
+
+    // the image may have moved, look the entry up again
+    SoundBankEntry *entry = (SoundBankEntry *)(out.data() + sizeof(SoundBankHeader)) + i;
+    memcpy(entry->name, name.c_str(), name.size() + 1);
+    entry->offset = offset;
+    entry->length = pcm.size();
+  }
+
+  SoundBankHeader *header = (SoundBankHeader *)out.data();
+  header->magic = SOUNDBANK_MAGIC;
+  header->version = SOUNDBANK_VERSION;
+  header->count = files.size();
+  header->sampleRate = SOUNDBANK_RATE;
+  header->size = out.size();
+  image.swap(out);
+  return true;
+}
+
+#endif
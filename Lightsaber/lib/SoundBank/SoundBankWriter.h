@@ -0,0 +1,29 @@
+#ifndef SoundBankWriter_h
+#define SoundBankWriter_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "SoundBank.h"
+
+//
+// Host side of the sound bank: turns wav files into a bank image.
+//
+// Used by tools/soundbank and test/test_sound_bank, not built for the
+// target. Sounds are mixed down to mono by WavReader and resampled to
+// SOUNDBANK_RATE, the name of a sound is its file name without ".wav".
+//
+#define SOUNDBANK_RATE  16000
+
+// Hann windowed sinc resampler, the cutoff sits below the lower Nyquist rate
+std::vector<int16_t> soundBankResample(const std::vector<int16_t> &in, uint32_t from, uint32_t to);
+
+// "dir/Hum-4.wav" -> "Hum-4"
+std::string soundBankName(const std::string &path);
+
+// Build the image from the wav files. On failure image is left empty and
+// error says which file and why.
+bool soundBankPack(const std::vector<std::string> &files, std::vector<uint8_t> &image, std::string &error);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef SpscRing_h
+#define SpscRing_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+//
+// Lock-free single producer / single consumer ring buffer.
+//
+// Exactly one task may call the write side (write/push/space) and exactly
+// one task may call the read side (read/pop/available). Head and tail are
+// free running 32 bit counters, the capacity N must be a power of two.
+//
+// Only depends on <atomic>, so the same header builds for the ESP32 and on
+// the host.
+//
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+  public:
+    static constexpr size_t capacity() { return N; }
+
+    // number of items ready to be read
+    size_t available() const {
+      return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed);
+    }
+
+    // number of items that can be written without overwriting unread data
+    size_t space() const {
+      return N - (_head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_acquire));
+    }
+
+    // producer side: copy up to count items in, returns the number written
+    size_t write(const T* data, size_t count) {
+      uint32_t head = _head.load(std::memory_order_relaxed);
+      uint32_t tail = _tail.load(std::memory_order_acquire);
+      size_t free = N - (head - tail);
+      if (count > free)
+        count = free;
+
+      size_t start = head & (N - 1);
+      size_t first = N - start;
+      if (first > count)
+        first = count;
+      for (size_t i = 0; i < first; i++)
+        _buffer[start + i] = data[i];
+      for (size_t i = first; i < count; i++)
+        _buffer[i - first] = data[i];
+
+      _head.store(head + count, std::memory_order_release);
+      return count;
+    }
+
+    // consumer side: copy up to count items out, returns the number read
+    size_t read(T* data, size_t count) {
+      uint32_t tail = _tail.load(std::memory_order_relaxed);
+      uint32_t head = _head.load(std::memory_order_acquire);
+      size_t used = head - tail;
+      if (count > used)
+        count = used;
+
+      size_t start = tail & (N - 1);
+      size_t first = N - start;
+      if (first > count)
+        first = count;
+      for (size_t i = 0; i < first; i++)
+        data[i] = _buffer[start + i];
+      for (size_t i = first; i < count; i++)
+        data[i] = _buffer[i - first];
+
+      _tail.store(tail + count, std::memory_order_release);
+      return count;
+    }
+
+    // drop all items, only while neither side is using the ring
+    void reset() {
+      _head.store(0, std::memory_order_relaxed);
+      _tail.store(0, std::memory_order_relaxed);
+    }
+
+    bool push(const T& item) { return write(&item, 1) == 1; }
+    bool pop(T& item) { return read(&item, 1) == 1; }
+
+  private:
+    T _buffer[N];
+    std::atomic<uint32_t> _head{0};   // only written by the producer
+    std::atomic<uint32_t> _tail{0};   // only written by the consumer
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include <stdio.h>
+
+#include "Trace.h"
+
+
+TraceRing traceRing;
+
+
+TraceRing::TraceRing() : _head(0), _enabled(true) {
+  clear();
+}
+
+
+void TraceRing::clear() {
+  for (TraceEvent &event : _events)
+    event.seq.store(0, std::memory_order_relaxed);
+  _head.store(0, std::memory_order_relaxed);
+}
+
+
+void TraceRing::dump(Print print, const char *const *names, uint16_t nameCount) {
+  char line[64];
+  bool wasEnabled = enabled();
+  enable(false);
+
+  uint32_t head = _head.load(std::memory_order_acquire);
+  uint32_t first = head > TRACE_EVENTS ? head - TRACE_EVENTS : 0;
+
+  snprintf(line, sizeof(line), "trace begin %u %u", head - first, traceCyclesPerUs());
+  print(line);
+  for (uint16_t i = 0; i < nameCount; i++) {
+    snprintf(line, sizeof(line), "trace name %u %s", i, names[i]);
+    print(line);
+  }
+
+  for (uint32_t seq = first; seq != head; seq++) {
+    const TraceEvent &event = _events[seq & (TRACE_EVENTS - 1)];
+    if (event.seq.load(std::memory_order_acquire) != seq + 1)
+      continue;                       // still being written
+    uint32_t cycles = event.cycles;
+    uint32_t arg = event.arg;
+    uint16_t id = event.id;
+    uint8_t kind = event.kind;
+    uint8_t core = event.core;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (event.seq.load(std::memory_order_relaxed) != seq + 1)
+      continue;                       // overwritten meanwhile
+
+    snprintf(line, sizeof(line), "trace %x %x %u %c %u %x", seq, cycles, id, kind, core, arg);
+    print(line);
+  }
+  print("trace end");
+  enable(wasEnabled);
+}
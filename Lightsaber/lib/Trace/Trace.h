@@ -0,0 +1,123 @@
+#ifndef Trace_h
+#define Trace_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+#ifndef SABER_TRACE
+#define SABER_TRACE 1           // -DSABER_TRACE=0 compiles the TRACE_* macros out
+#endif
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS 512        // ring size, power of two, 16 bytes each
+#endif
+
+// CPU cycle counter and core of the caller. On the host the "cycles" are
+// nanoseconds of the steady clock.
+#ifdef ARDUINO
+inline uint32_t traceCycles() { return ESP.getCycleCount(); }
+inline uint8_t traceCore() { return xPortGetCoreID(); }
+inline uint32_t traceCyclesPerUs() { return getCpuFrequencyMhz(); }
+#else
+inline uint32_t traceCycles() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+inline uint8_t traceCore() { return 0; }
+inline uint32_t traceCyclesPerUs() { return 1000; }
+#endif
+
+// Chrome trace phases
+enum TraceKind : uint8_t {
+  TRACE_KIND_BEGIN = 'B',
+  TRACE_KIND_END = 'E',
+  TRACE_KIND_INSTANT = 'i',
+  TRACE_KIND_COUNTER = 'C',
+};
+
+struct TraceEvent {
+  std::atomic<uint32_t> seq;    // event number + 1, written last, 0 = empty
+  uint32_t cycles;
+  uint32_t arg;
+  uint16_t id;
+  uint8_t kind;
+  uint8_t core;
+};
+
+//
+// Flight recorder for the hot paths.
+//
+// Any task or interrupt on either core records compact binary events into
+// a ring of TRACE_EVENTS slots, the oldest are overwritten. Recording is a
+// fetch_add on the head and four stores, no lock and no formatting, so it
+// can sit inside the mixer, the LED output or an ISR without moving their
+// timing. dump() prints the ring as text lines over serial on demand,
+// tools/trace turns them into Chrome trace / Perfetto JSON.
+//
+// Every slot carries its event number, written last: a slot still being
+// written while dump() reads it is recognised and skipped.
+//
+class TraceRing {
+  static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+
+  public:
+    typedef void (*Print)(const char *line);
+
+    TraceRing();
+
+    void record(uint16_t id, TraceKind kind, uint32_t arg = 0) {
+      if (!_enabled.load(std::memory_order_relaxed))
+        return;
+      uint32_t seq = _head.fetch_add(1, std::memory_order_relaxed);
+      TraceEvent &event = _events[seq & (TRACE_EVENTS - 1)];
+      event.seq.store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      event.cycles = traceCycles();
+      event.arg = arg;
+      event.id = id;
+      event.kind = kind;
+      event.core = traceCore();
+      event.seq.store(seq + 1, std::memory_order_release);
+    }
+
+    void enable(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+    // events recorded since boot, including the overwritten ones
+    uint32_t recorded() const { return _head.load(std::memory_order_relaxed); }
+    void clear();
+
+    // Prints the ring, oldest first, recording is paused meanwhile:
+    //   trace begin <events> <cycles per us>
+    //   trace name <id> <name>              for each of names
+    //   trace <seq> <cycles> <id> <kind> <core> <arg>
+    //   trace end
+    // seq, cycles and arg are hex.
+    void dump(Print print, const char *const *names, uint16_t nameCount);
+
+  private:
+    TraceEvent _events[TRACE_EVENTS];
+    std::atomic<uint32_t> _head;
+    std::atomic<bool> _enabled;
+};
+
+extern TraceRing traceRing;
+
+#if SABER_TRACE
+#define TRACE_BEGIN(id, arg)    traceRing.record((id), TRACE_KIND_BEGIN, (arg))
+#define TRACE_END(id, arg)      traceRing.record((id), TRACE_KIND_END, (arg))
+#define TRACE_INSTANT(id, arg)  traceRing.record((id), TRACE_KIND_INSTANT, (arg))
+#define TRACE_COUNTER(id, value) traceRing.record((id), TRACE_KIND_COUNTER, (value))
+#else
+#define TRACE_BEGIN(id, arg)
+#define TRACE_END(id, arg)
+#define TRACE_INSTANT(id, arg)
+#define TRACE_COUNTER(id, value)
+#endif
+
+#endif
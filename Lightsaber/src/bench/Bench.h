@@ -0,0 +1,87 @@
+#ifndef Bench_h
+#define Bench_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "ByteSource.h"
+
+//
+// Helpers shared by the benchmark scenarios in src/bench, see main.cpp.
+//
+
+struct Stats {
+  uint32_t p50, p99, max;
+};
+
+inline Stats stats(std::vector<uint32_t> &values) {
+  if (values.empty())
+    return { 0, 0, 0 };
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  return { values[n / 2], values[std::min(n - 1, n * 99 / 100)], values[n - 1] };
+}
+
+inline void json(const char *key, Stats s, bool last = false) {
+  printf("\"%s\":{\"p50\":%u,\"p99\":%u,\"max\":%u}%s", key, s.p50, s.p99, s.max, last ? "" : ",");
+}
+
+inline uint32_t nsSince(std::chrono::steady_clock::time_point start) {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+// results are stored here so the compiler keeps the work being timed
+extern volatile uint32_t benchSink;
+
+// median host time of one fn(i) call, timed in batches of calls to keep
+// the clock out of the result
+template <typename F>
+double callNs(int batches, int calls, F fn) {
+  std::vector<uint32_t> batchNs;
+  for (int b = 0; b < batches; b++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++)
+      fn(i);
+    batchNs.push_back(nsSince(start));
+  }
+  return stats(batchNs).p50 / (double)calls;
+}
+
+// ByteSource on a regular file
+class StdioSource : public ByteSource {
+  public:
+    ~StdioSource() { if (f) fclose(f); }
+    bool open(const char *path) { f = fopen(path, "rb"); return f != nullptr; }
+    size_t read(uint8_t *data, size_t len) override { return fread(data, 1, len, f); }
+    bool seek(uint32_t pos) override { return fseek(f, pos, SEEK_SET) == 0; }
+    uint32_t size() override {
+      long pos = ftell(f);
+      fseek(f, 0, SEEK_END);
+      long size = ftell(f);
+      fseek(f, pos, SEEK_SET);
+      return size;
+    }
+  private:
+    FILE *f = nullptr;
+};
+
+// library scenarios, one JSON object per result on stdout and a line of
+// the table on stderr
+void benchMixer();
+void benchEnvelope(const char *dataDir);
+void benchCurves();
+void benchMotion();
+void benchGestures();
+void benchEffects();
+void benchColor();
+void benchSegments();
+void benchLimiter();
+void benchEncoder();
+void benchSwing(const char *dataDir, const char *wavPath);
+void benchReadAhead(const char *dataDir);
+
+#endif
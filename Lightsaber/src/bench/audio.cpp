@@ -0,0 +1,156 @@
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "Mixer.h"
+#include "MemoryPcm.h"
+#include "Envelope.h"
+#include "WavReader.h"
+#include "HumLoop.h"
+#include "SmoothSwing.h"
+#include "NativeHal.h"
+
+
+// all samples of a wav file in data/, empty if it is missing
+static std::vector<int16_t> loadWav(const char *dataDir, const char *name) {
+  std::vector<int16_t> samples;
+  StdioSource file;
+  WavReader wav;
+  std::string path = std::string(dataDir) + "/" + name;
+  if (!file.open(path.c_str()) || !wav.begin(file)) {
+    fprintf(stderr, "%s: no 16 bit wav file\n", path.c_str());
+    return samples;
+  }
+  samples.resize(wav.length());
+  samples.resize(wav.read(samples.data(), samples.size()));
+  return samples;
+}
+
+
+// Mixer::mix() with 1 .. MIXER_VOICES looped voices, ns per output sample.
+// One I2S block of 256 samples is 16 ms of audio at 16 kHz, the time to
+// mix it is printed next to it.
+void benchMixer() {
+  static int16_t tone[4000];
+  static MemoryPcm pcm[MIXER_VOICES];
+  static Mixer mixer;
+  static int32_t out[MIXER_BLOCK];
+
+  for (int i = 0; i < 4000; i++)
+    tone[i] = (int16_t)(12000 * sin(2 * M_PI * i / 72.7));
+
+  for (int voices = 1; voices <= MIXER_VOICES; voices++) {
+    mixer.stopAll();
+    for (int v = 0; v < voices; v++) {
+      pcm[v].begin(tone, 4000);
+      mixer.play(v, pcm[v], MIXER_UNITY / 2, true);
+    }
+    double ns = callNs(2000, 16, [](int) {
+      mixer.mix(out, MIXER_BLOCK);
+      benchSink = out[0];
+    }) / MIXER_BLOCK;
+    printf("{\"scenario\":\"mixer\",\"voices\":%d,\"ns_per_sample\":%.2f,\"block_us\":%.2f}\n",
+           voices, ns, ns * MIXER_BLOCK / 1000);
+    fprintf(stderr, "mixer %d voices %.2f ns/sample, %.2f us per %d sample block\n",
+            voices, ns, ns * MIXER_BLOCK / 1000, MIXER_BLOCK);
+  }
+}
+
+
+// Envelope::process() on Hum-4.wav in I2S blocks, as the mixer task runs
+// it after every mix. A 256 sample block is 16 ms of audio, the share of
+// that is the CPU the follower takes.
+void benchEnvelope(const char *dataDir) {
+  static std::vector<int32_t> i2s;
+  static Envelope envelope;
+  std::vector<int16_t> hum = loadWav(dataDir, "Hum-4.wav");
+  if (hum.size() < MIXER_BLOCK)
+    return;
+  for (int16_t s : hum)
+    i2s.push_back((int32_t)s * 65536);
+
+  static size_t blocks;
+  blocks = i2s.size() / MIXER_BLOCK;
+  double ns = callNs(200, (int)blocks, [](int i) {
+    envelope.process(i2s.data() + i * MIXER_BLOCK, MIXER_BLOCK);
+    benchSink = envelope.level();
+  });
+  double share = ns / (MIXER_BLOCK * 1e9 / 16000) * 100;
+  printf("{\"scenario\":\"envelope\",\"blocks\":%zu,\"ns_per_block\":%.1f,\"ns_per_sample\":%.2f,\"cpu_percent\":%.4f}\n",
+         blocks, ns, ns / MIXER_BLOCK, share);
+  fprintf(stderr, "envelope on Hum-4.wav %.1f ns per %d sample block (%.2f ns/sample, %.4f%% of a core)\n",
+          ns, MIXER_BLOCK, ns / MIXER_BLOCK, share);
+}
+
+
+// SmoothSwing over the Hum-4.wav / swing.wav loops, rendering 10 s of a
+// scripted swing: at rest, a swing every second whose peak speed steps up
+// to SWING_MAX_SPEED, and one held at full speed at the end. The speed is
+// set every 2 ms like the motion task does. Reports the host time per
+// rendered second of audio; with a path the result is written as a wav
+// file to listen to.
+void benchSwing(const char *dataDir, const char *wavPath) {
+  static std::vector<int16_t> hum, swingHum;
+  static MemoryPcm humPcm, swingPcm;
+  static HumLoop humLoop, swingLoop;
+  static SmoothSwing swing;
+  static int16_t block[SWING_BLOCK];
+  const uint32_t rate = 22050;      // the rate of the wavs in data/
+  const uint32_t seconds = 10;
+
+  hum = loadWav(dataDir, "Hum-4.wav");
+  swingHum = loadWav(dataDir, "swing.wav");
+  if (hum.size() < 1024 || swingHum.size() < 1024)
+    return;
+
+  WavSink sink(wavPath);
+  if (!sink.begin(rate)) {
+    fprintf(stderr, "%s: cannot write\n", wavPath);
+    return;
+  }
+
+  std::vector<uint32_t> secondNs;
+  for (int pass = 0; pass < 20; pass++) {
+    humPcm.begin(hum.data(), hum.size());
+    swingPcm.begin(swingHum.data(), swingHum.size());
+    humLoop.begin(humPcm, 512);
+    swingLoop.begin(swingPcm, 512);
+    swing.begin(humLoop, swingLoop);
+
+    for (uint32_t second = 0; second < seconds; second++) {
+      uint32_t samples = 0;
+      auto start = std::chrono::steady_clock::now();
+      while (samples < rate) {
+        uint32_t ms = second * 1000 + samples * 1000 / rate;
+        uint32_t phase = ms % 1000;
+        uint32_t peak = second == seconds - 1 ? SWING_MAX_SPEED : SWING_MAX_SPEED * (second + 1) / seconds;
+        uint32_t speed = second == seconds - 1 ? peak : phase < 400 ? peak * (phase < 200 ? phase : 400 - phase) / 200 : 0;
+        swing.setSpeed(speed);
+        // 2 ms of audio per speed update
+        size_t n = std::min<size_t>(rate / 500, rate - samples);
+        n = swing.read(block, n);
+        benchSink = block[0];
+        if (pass == 0 && wavPath) {
+          int32_t i2s[SWING_BLOCK];
+          for (size_t i = 0; i < n; i++)
+            i2s[i] = (int32_t)block[i] * 65536;
+          sink.write(i2s, n);
+        }
+        samples += n;
+      }
+      if (pass > 0)
+        secondNs.push_back(nsSince(start));
+    }
+  }
+  sink.close();
+
+  Stats s = stats(secondNs);
+  double share = s.p50 / 1e9 * 100;
+  printf("{\"scenario\":\"smooth_swing\",\"rate\":%u,\"seconds\":%u,", rate, seconds);
+  json("ns_per_second", s);
+  printf("\"cpu_percent\":%.4f}\n", share);
+  fprintf(stderr, "smooth swing %u ns per rendered second (p99 %u, %.4f%% of a core)%s%s\n",
+          s.p50, s.p99, share, wavPath ? ", written to " : "", wavPath ? wavPath : "");
+}
@@ -0,0 +1,48 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "Bench.h"
+#include "Blade.h"
+
+#define BLADE_PIXELS 50
+#define BLADE_MS     980
+
+
+// Lit pixels of one frame of the ignition: the old per frame
+// pow(fraction, 0.5) in double with the float conversions around it,
+// against the constexpr table lookup of every curve, and a whole
+// Blade::update() frame.
+void benchCurves() {
+  double powNs = callNs(2000, 1000, [](int i) {
+    uint32_t elapsed = i % BLADE_MS;
+    float fraction = (float)elapsed / BLADE_MS;
+    fraction = pow(fraction, 0.5);
+    benchSink = int(BLADE_PIXELS * fraction + 0.5);
+  });
+  printf("{\"scenario\":\"ignition_curve\",\"curve\":\"pow\",\"ns_per_frame\":%.2f}\n", powNs);
+  fprintf(stderr, "ignition frame pow() %.2f ns", powNs);
+
+  static const char *names[CURVE_COUNT] = { "sqrt", "ease", "bounce", "flicker" };
+  for (int c = 0; c < CURVE_COUNT; c++) {
+    static IgnitionCurve curve;
+    curve = (IgnitionCurve)c;
+    double ns = callNs(2000, 1000, [](int i) {
+      uint32_t t = ((uint32_t)(i % BLADE_MS) << 16) / BLADE_MS;
+      benchSink = (curveAt(curve, t) * BLADE_PIXELS + 0x8000) >> 16;
+    });
+    printf("{\"scenario\":\"ignition_curve\",\"curve\":\"%s\",\"ns_per_frame\":%.2f}\n", names[c], ns);
+    fprintf(stderr, ", %s %.2f ns", names[c], ns);
+  }
+
+  static Blade blade(BLADE_PIXELS);
+  double updateNs = callNs(2000, 1000, [](int i) {
+    if (i == 0) {
+      blade = Blade(BLADE_PIXELS);
+      blade.ignite(0, BLADE_MS);
+    }
+    blade.update(i);
+    benchSink = blade.lit();
+  });
+  printf("{\"scenario\":\"blade_update\",\"ns\":%.2f}\n", updateNs);
+  fprintf(stderr, ", Blade::update() %.2f ns\n", updateNs);
+}
@@ -0,0 +1,66 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Bench.h"
+#include "Color.h"
+
+#define MAX_PIXELS 300
+
+
+// the same frame pass, one float per channel: blend, brightness, gamma
+static uint32_t naivePixel(uint32_t dst, uint32_t src, float alpha, float brightness) {
+  uint32_t out = 0;
+  for (int shift = 16; shift >= 0; shift -= 8) {
+    float d = (dst >> shift & 0xff) / 255.0f;
+    float s = (src >> shift & 0xff) / 255.0f;
+    float v = s * alpha + d * (1 - alpha);
+    v = powf(v, 2.5f) * brightness;
+    out |= (uint32_t)(v * 255 + 0.5f) << shift;
+  }
+  return out;
+}
+
+
+// One frame pass at 50, 144 and 300 pixels: blend a flash over the blade
+// colors, then gamma and brightness on the way out. Packed, that is
+// blendColor() plus a ColorLut::map() per pixel; naive, every channel is
+// unpacked to float, blended, scaled and run through powf(). The gamma
+// step is also timed alone: ColorLut::apply() against powf() per channel.
+void benchColor() {
+  static uint32_t blade[MAX_PIXELS], out[MAX_PIXELS];
+  static ColorLut lut;
+  static uint16_t pixels;
+  for (int i = 0; i < MAX_PIXELS; i++)
+    blade[i] = ((uint32_t)rand() << 8 ^ rand()) & 0xffffff;
+  lut.setBrightness(200);
+
+  for (uint16_t count : { 50, 144, 300 }) {
+    pixels = count;
+    double packed = callNs(500, 10, [](int i) {
+      uint16_t alpha = i * 25;
+      for (uint16_t p = 0; p < pixels; p++)
+        out[p] = lut.map(blendColor(blade[p], 0xffffff, alpha));
+      benchSink = out[pixels / 2];
+    });
+    double naive = callNs(500, 10, [](int i) {
+      float alpha = i * 25 / 256.0f;
+      for (uint16_t p = 0; p < pixels; p++)
+        out[p] = naivePixel(blade[p], 0xffffff, alpha, 201 / 256.0f);
+      benchSink = out[pixels / 2];
+    });
+    double lutNs = callNs(500, 10, [](int) {
+      lut.apply(blade, out, pixels);
+      benchSink = out[pixels / 2];
+    });
+    double powNs = callNs(500, 10, [](int) {
+      for (uint16_t p = 0; p < pixels; p++)
+        out[p] = naivePixel(blade[p], blade[p], 1, 201 / 256.0f);
+      benchSink = out[pixels / 2];
+    });
+    printf("{\"scenario\":\"color\",\"pixels\":%u,\"packed_ns\":%.1f,\"naive_ns\":%.1f,\"lut_ns\":%.1f,\"pow_ns\":%.1f}\n",
+           count, packed, naive, lutNs, powNs);
+    fprintf(stderr, "color %3u px frame pass packed %.1f ns, naive float %.1f ns; gamma lut %.1f ns, powf %.1f ns\n",
+            count, packed, naive, lutNs, powNs);
+  }
+}
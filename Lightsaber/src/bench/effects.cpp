@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <string>
+
+#include "Bench.h"
+#include "EffectEngine.h"
+
+#define FLASH_COLOR 0xffffff
+
+
+// EffectEngine::render() of one frame for every combination of the
+// flicker, lockup, blaster and clash layers over the base, on a 50 and a
+// 150 pixel blade. The flashes run without a duration so they stay on for
+// the whole measurement. At 100 fps a frame has 10 ms, the target is well
+// under 1 ms.
+void benchEffects() {
+  static const uint8_t layers[] = { EFFECT_FLICKER, EFFECT_LOCKUP, EFFECT_BLASTER, EFFECT_CLASH };
+  static const char *names[] = { "flicker", "lockup", "blaster", "clash" };
+  static uint32_t frame[150];
+  static EffectEngine engine;
+  static uint16_t pixels;
+
+  for (uint16_t count : { 50, 150 }) {
+    pixels = count;
+    double fastest = 1e9, slowest = 0;
+    std::string fastestName, slowestName;
+    for (unsigned mask = 0; mask < 16; mask++) {
+      std::string name = "base";
+      for (int type = EFFECT_BASE; type < EFFECT_TYPES; type++)
+        engine.stopAll(type);
+      engine.start({ EFFECT_BASE, 0x0000ff, 0, 0, 0, 0 }, 0);
+      for (int l = 0; l < 4; l++) {
+        if (!(mask & 1u << l))
+          continue;
+        engine.start({ layers[l], FLASH_COLOR, 0, (uint16_t)(count * 2 / 3), 8, 96 }, 0);
+        name += "+";
+        name += names[l];
+      }
+
+      double ns = callNs(200, 100, [](int i) {
+        engine.render(i, frame, pixels, pixels, (uint16_t)(i * 41 % FLICKER_FULL));
+        benchSink = frame[pixels / 2];
+      });
+      printf("{\"scenario\":\"effects\",\"pixels\":%u,\"layers\":\"%s\",\"ns_per_frame\":%.1f}\n",
+             count, name.c_str(), ns);
+      if (ns < fastest) {
+        fastest = ns;
+        fastestName = name;
+      }
+      if (ns > slowest) {
+        slowest = ns;
+        slowestName = name;
+      }
+    }
+    fprintf(stderr, "effects %u px: %.1f ns per frame %s .. %.1f ns %s\n",
+            count, fastest, fastestName.c_str(), slowest, slowestName.c_str());
+  }
+}
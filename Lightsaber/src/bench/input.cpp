@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <vector>
+
+#include "Bench.h"
+#include "GestureRecognizer.h"
+
+
+// GestureRecognizer on 10 s of scripted input: clicks, double clicks,
+// holds and hold-clicks, every press with a few ms of contact bounce.
+// update() runs every ms like loop() does, edge() as the edges come in;
+// both are timed per call.
+void benchGestures() {
+  static std::vector<ButtonEdge> edges;
+  for (uint32_t t = 0; t < 10000; t += 2500) {
+    const uint32_t presses[][2] = { { 100, 80 }, { 600, 80 }, { 750, 80 }, { 1200, 900 },
+                                    { 2200, 80 }, { 2350, 0 } };
+    for (auto &p : presses) {
+      uint32_t start = t + p[0];
+      uint32_t length = p[1] ? p[1] : 900;
+      edges.push_back({ start, true });
+      edges.push_back({ start + 2, false });
+      edges.push_back({ start + 4, true });
+      edges.push_back({ start + length, false });
+      edges.push_back({ start + length + 3, true });
+      edges.push_back({ start + length + 5, false });
+    }
+  }
+
+  static GestureRecognizer recognizer;
+  static uint32_t gestures;
+  double edgeNs = callNs(200, (int)edges.size(), [](int i) {
+    recognizer.edge(edges[i]);
+    Gesture gesture;
+    while (recognizer.pop(gesture))
+      gestures++;
+  });
+  double updateNs = callNs(200, 10000, [](int i) {
+    recognizer.update(i);
+    benchSink = recognizer.pressed();
+  });
+  printf("{\"scenario\":\"gestures\",\"edges\":%zu,\"edge_ns\":%.2f,\"update_ns\":%.2f,\"gestures_per_pass\":%u}\n",
+         edges.size(), edgeNs, updateNs, gestures / 200);
+  fprintf(stderr, "gestures edge %.2f ns, update %.2f ns, %u gestures per 10 s\n",
+          edgeNs, updateNs, gestures / 200);
+}
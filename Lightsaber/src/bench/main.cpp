@@ -0,0 +1,225 @@
+//
+// Frame timing benchmark of the firmware loop: pio run -e bench, then
+//   .pio/build/bench/program [data dir] [repeat] [swing.wav] > bench.jsonl
+//
+// Every scenario scripts the button of a fresh Simulation (lib/Sim) and
+// measures a window of it in 1 ms steps of virtual time: the host time of
+// loop(), the motion, mixer and I2S steps (p50/p99/max), audio underruns
+// and the interval between LED frames in virtual time. The inputs are the
+// same in every run, only the host timings move.
+//
+// The last lines time TraceRing::record(), enabled and paused, the hot
+// paths above carry those events, and a log call compiled out, deferred
+// (Log.h, drain included) and formatted directly like Serial.printf, then
+// a metrics counter update and one metrics line (Metrics.h). The library
+// scenarios after them time single components: the mixer per voice count
+// and the envelope follower on data/Hum-4.wav (audio.cpp), the ignition
+// curves against pow() (blade.cpp), swing / clash detection on a
+// replayed trace (motion.cpp), button gestures (input.cpp), a blade
+// frame per combination of effect layers (effects.cpp), packed color
+// math and the gamma lut against float per channel (color.cpp), a frame
+// split over several strips, the output pass with and without the
+// current limit and the WS2812 symbol encoding (strips.cpp), 10 s of
+// smooth swing rendered from a scripted swing (audio.cpp), written to the
+// optional wav path, and the decoder side of ReadAhead against plain file
+// reads (readahead.cpp).
+//
+// stdout gets one JSON object per scenario, diff it between commits;
+// stderr gets a table.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "Bench.h"
+#include "Simulation.h"
+#include "Trace.h"
+#include "Log.h"
+#include "Metrics.h"
+
+
+struct Scenario {
+  const char *name;
+  void (*script)(ScriptedButton &button);
+  uint32_t from;          // measured window, ms of virtual time
+  uint32_t to;
+};
+
+volatile uint32_t benchSink;
+
+static const Scenario scenarios[] = {
+  // on at ~0.8 s, measure the steady hum with swings and a clash
+  { "idle_hum", [](ScriptedButton &b) { b.press(500, 80); }, 2500, 12500 },
+  // the ignition itself
+  { "ignition", [](ScriptedButton &b) { b.press(500, 80); }, 800, 2000 },
+  // on, hold off at 3.8 s
+  { "retraction", [](ScriptedButton &b) { b.press(500, 80); b.press(3000, 900); }, 3800, 5000 },
+  // click on, hold off, every 1.5 s
+  { "rapid_on_off", [](ScriptedButton &b) {
+      for (uint32_t t = 0; t < 15000; t += 1500) {
+        b.press(t + 100, 80);
+        b.press(t + 500, 850);
+      }
+    }, 0, 15000 },
+};
+
+
+int main(int argc, char **argv) {
+  const char *dataDir = argc > 1 ? argv[1] : "data";
+  int repeat = argc > 2 ? atoi(argv[2]) : 5;
+  const char *swingWav = argc > 3 ? argv[3] : nullptr;
+
+  fprintf(stderr, "%-14s %10s %10s %10s %10s %10s %6s %8s %10s\n", "scenario", "loop p50",
+          "loop p99", "loop max", "mix p99", "i2s p99", "under", "frames", "frame p99");
+
+  for (const Scenario &scenario : scenarios) {
+    std::vector<uint32_t> loopNs, motionNs, mixNs, audioNs, intervalUs;
+    uint32_t underruns = 0;
+    uint32_t frames = 0;
+
+    for (int r = 0; r < repeat; r++) {
+      Simulation *sim = new Simulation(dataDir, nullptr, true);
+      if (!sim->begin()) {
+        fprintf(stderr, "%s: no config or strips in %s\n", scenario.name, dataDir);
+        return 1;
+      }
+      scenario.script(sim->button);
+      sim->run(scenario.from);
+
+      uint32_t startUnderruns = sim->saber().audioUnderruns();
+      uint32_t lastFrames = sim->strips[0].frames();
+      uint64_t lastFrame = 0;
+      for (uint32_t ms = scenario.from; ms < scenario.to; ms++) {
+        StepTimes t = sim->step();
+        loopNs.push_back(t.loopNs);
+        if (t.motionNs)
+          motionNs.push_back(t.motionNs);
+        if (t.mixNs)
+          mixNs.push_back(t.mixNs);
+        if (t.audioNs)
+          audioNs.push_back(t.audioNs);
+
+        if (sim->strips[0].frames() != lastFrames) {
+          lastFrames = sim->strips[0].frames();
+          frames++;
+          if (lastFrame)
+            intervalUs.push_back((uint32_t)(sim->clock.now() - lastFrame));
+          lastFrame = sim->clock.now();
+        }
+      }
+      underruns += sim->saber().audioUnderruns() - startUnderruns;
+      delete sim;
+    }
+
+    Stats loop = stats(loopNs), motion = stats(motionNs), mix = stats(mixNs);
+    Stats audio = stats(audioNs), interval = stats(intervalUs);
+
+    printf("{\"scenario\":\"%s\",\"repeat\":%d,\"steps\":%zu,", scenario.name, repeat, loopNs.size());
+    json("loop_ns", loop);
+    json("motion_ns", motion);
+    json("mix_ns", mix);
+    json("audio_ns", audio);
+    printf("\"underruns\":%u,\"frames\":%u,", underruns, frames);
+    json("frame_interval_us", interval);
+    printf("\"frame_jitter_us\":%u}\n", interval.p99 - interval.p50);
+
+    fprintf(stderr, "%-14s %10u %10u %10u %10u %10u %6u %8u %10u\n", scenario.name, loop.p50,
+            loop.p99, loop.max, mix.p99, audio.p99, underruns, frames, interval.p99);
+  }
+
+  // cost of one trace event, in batches of 1000 to keep the clock out
+  const int batches = 2000;
+  double ns[2];
+  for (int paused = 0; paused < 2; paused++) {
+    std::vector<uint32_t> batchNs;
+    traceRing.enable(!paused);
+    for (int b = 0; b < batches; b++) {
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < 1000; i++)
+        traceRing.record(1, TRACE_KIND_INSTANT, i);
+      batchNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    }
+    ns[paused] = stats(batchNs).p50 / 1000.0;
+  }
+  traceRing.enable(true);
+  printf("{\"scenario\":\"trace_record\",\"ns\":%.2f,\"paused_ns\":%.2f}\n", ns[0], ns[1]);
+  fprintf(stderr, "trace record %.2f ns, paused %.2f ns\n", ns[0], ns[1]);
+
+  // one log call with two numbers, LOG_RECORDS / 2 per batch so the
+  // deferred ring never drops, the drain is part of the deferred cost
+  static FILE *sink = fopen("/dev/null", "w");
+  const int calls = LOG_RECORDS / 2;
+  std::vector<uint32_t> disabledNs, deferredNs, drainNs, directNs;
+  for (int b = 0; b < batches; b++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++)
+      LOG_DEBUG("bench %u of %u", i, calls);
+    auto mid = std::chrono::steady_clock::now();
+    disabledNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count());
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++)
+      LOG_INFO("bench %u of %u", i, calls);
+    mid = std::chrono::steady_clock::now();
+    logBuffer.drain([](const char *line) { fputs(line, sink); fputc('\n', sink); });
+    auto end = std::chrono::steady_clock::now();
+    deferredNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count());
+    drainNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count());
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+      char line[64];
+      snprintf(line, sizeof(line), "%u.%03u INFO  bench %u of %u", i / 1000, i % 1000, i, calls);
+      fputs(line, sink);
+      fputc('\n', sink);
+    }
+    directNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  }
+  double disabled = stats(disabledNs).p50 / (double)calls;
+  double deferred = stats(deferredNs).p50 / (double)calls;
+  double drain = stats(drainNs).p50 / (double)calls;
+  double direct = stats(directNs).p50 / (double)calls;
+  printf("{\"scenario\":\"log_call\",\"disabled_ns\":%.2f,\"deferred_ns\":%.2f,\"drain_ns\":%.2f,\"direct_ns\":%.2f}\n",
+         disabled, deferred, drain, direct);
+  fprintf(stderr, "log call disabled %.2f ns, deferred %.2f ns (+%.2f ns drain), direct %.2f ns\n",
+          disabled, deferred, drain, direct);
+
+  // one counter update, and snapshot plus format of the whole registry
+  int id = metrics.add("bench", METRIC_COUNTER);
+  std::vector<uint32_t> incNs, lineNs;
+  for (int b = 0; b < batches; b++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++)
+      metrics.inc(id);
+    auto mid = std::chrono::steady_clock::now();
+    MetricsSnapshot snapshot;
+    char line[384];
+    metrics.snapshot(snapshot, b);
+    metrics.format(snapshot, nullptr, line, sizeof(line));
+    auto end = std::chrono::steady_clock::now();
+    incNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count());
+    lineNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count());
+  }
+  double inc = stats(incNs).p50 / 1000.0;
+  uint32_t line = stats(lineNs).p50;
+  printf("{\"scenario\":\"metrics\",\"inc_ns\":%.2f,\"line_ns\":%u}\n", inc, line);
+  fprintf(stderr, "metrics inc %.2f ns, line %u ns\n", inc, line);
+
+  benchMixer();
+  benchEnvelope(dataDir);
+  benchCurves();
+  benchMotion();
+  benchGestures();
+  benchEffects();
+  benchColor();
+  benchSegments();
+  benchLimiter();
+  benchEncoder();
+  benchSwing(dataDir, swingWav);
+  benchReadAhead(dataDir);
+  return 0;
+}
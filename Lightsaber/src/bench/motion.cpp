@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <vector>
+
+#include "Bench.h"
+#include "MotionDetector.h"
+#include "TraceSensor.h"
+
+#define MOTION_PERIOD 2      // ms, as SABER_MOTION_PERIOD
+
+
+// MotionDetector::update() replaying 10 s of a recorded style trace
+// through a TraceSensor: at rest, a swing every second and a clash every
+// 2.5 s. The motion task has 2 ms per sample on the device.
+void benchMotion() {
+  static std::vector<MotionSample> trace;
+  for (uint32_t t = 0; t < 10000; t += MOTION_PERIOD) {
+    MotionSample s = { 0, 0, MOTION_ACCEL_1G, 0, 0, 0 };
+    uint32_t phase = t % 1000;
+    if (phase < 300)
+      s.gy = (int16_t)(phase < 150 ? phase * 60 : (300 - phase) * 60);
+    if (t % 2500 < 4)
+      s.ax = 4 * MOTION_ACCEL_1G;
+    trace.push_back(s);
+  }
+
+  static TraceSensor sensor(trace.data(), trace.size(), true);
+  static MotionDetector detector;
+  static uint32_t events;
+  sensor.begin();
+  double ns = callNs(200, (int)trace.size(), [](int i) {
+    MotionSample sample;
+    MotionEvent event;
+    sensor.read(sample);
+    events += detector.update(sample, i * MOTION_PERIOD, event);
+    benchSink = detector.swingSpeed();
+  });
+  printf("{\"scenario\":\"motion\",\"samples\":%zu,\"ns_per_sample\":%.2f,\"events_per_pass\":%u}\n",
+         trace.size(), ns, events / 200);
+  fprintf(stderr, "motion detector %.2f ns per sample, %u events per 10 s\n", ns, events / 200);
+}
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "ReadAhead.h"
+
+#define READ_CHUNK 512       // bytes per decoder read, as StreamCopy
+#define PASSES     20
+
+
+// the other side needs the CPU, the bench host may have a single core
+static void waitABit() {
+  std::this_thread::sleep_for(std::chrono::microseconds(20));
+}
+
+static void report(const char *mode, int watermark, size_t bytes, uint32_t ns,
+                   uint32_t stalls, std::vector<uint32_t> &readNs) {
+  Stats s = stats(readNs);
+  double mbs = bytes * 1000.0 / ns;
+  printf("{\"scenario\":\"readahead\",\"mode\":\"%s\",\"watermark\":%d,\"mb_per_s\":%.1f,\"stalls\":%u,",
+         mode, watermark, mbs, stalls);
+  json("read_ns", s, true);
+  printf("}\n");
+  fprintf(stderr, "readahead %-6s watermark %d: %.1f MB/s, %u stalls, read p50 %u ns p99 %u ns max %u ns\n",
+          mode, watermark, mbs, stalls, s.p50, s.p99, s.max);
+}
+
+
+// Hum-4.wav read in READ_CHUNK pieces by a decoder thread, straight from
+// the file and through a ReadAhead with a filler thread per watermark.
+// The read times are what lands in the decode path, a read that finds the
+// buffer empty before the end of the file is a stall (the decoder waits
+// and tries again, the wait is not in read_ns).
+void benchReadAhead(const char *dataDir) {
+  std::string path = std::string(dataDir) + "/Hum-4.wav";
+  StdioSource file;
+  if (!file.open(path.c_str())) {
+    fprintf(stderr, "%s: missing\n", path.c_str());
+    return;
+  }
+  uint32_t size = file.size();
+  static uint8_t chunk[READ_CHUNK];
+
+  std::vector<uint32_t> readNs;
+  auto start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < PASSES; pass++) {
+    file.seek(0);
+    size_t n;
+    do {
+      auto t = std::chrono::steady_clock::now();
+      n = file.read(chunk, READ_CHUNK);
+      readNs.push_back(nsSince(t));
+      benchSink = chunk[0];
+    } while (n == READ_CHUNK);
+  }
+  report("direct", 0, (size_t)size * PASSES, nsSince(start), 0, readNs);
+
+  static ReadAhead ahead;
+  static std::atomic<bool> stop;
+  for (int watermark = 1; watermark <= READAHEAD_BLOCKS; watermark *= 2) {
+    readNs.clear();
+    uint32_t stalls = ahead.stalls();
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++) {
+      file.seek(0);
+      ahead.begin(file, watermark);
+      stop = false;
+      std::thread filler([] {
+        while (!stop)
+          if (ahead.fill() == 0)
+            waitABit();
+      });
+      while (!ahead.eof()) {
+        auto t = std::chrono::steady_clock::now();
+        size_t n = ahead.read(chunk, READ_CHUNK);
+        readNs.push_back(nsSince(t));
+        benchSink = chunk[0];
+        if (n == 0)
+          waitABit();
+      }
+      stop = true;
+      filler.join();
+    }
+    stalls = ahead.stalls() - stalls;
+    report("ahead", watermark, (size_t)size * PASSES, nsSince(start), stalls, readNs);
+  }
+}
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Bench.h"
+#include "MultiStrip.h"
+#include "LedRenderer.h"
+#include "Ws2812Encoder.h"
+
+#define PIXEL_WIRE_US 30     // WS2812, 24 bits at 800 kHz
+
+
+// takes the segment and drops it, the RMT encoding is timed by benchEncoder()
+class NullStrip : public StripDriver {
+  public:
+    void show(const uint32_t *frame, uint16_t count) override { benchSink = frame[count - 1]; }
+};
+
+
+// MultiStrip::show() of one frame through the SegmentMap, 1, 2 and 4
+// strips, independent segments and mirrored, one reversed strip each. The
+// wire time is that of the longest segment, which is what a frame costs
+// with all strips sent in parallel.
+void benchSegments() {
+  static uint32_t frame[STRIP_MAX_PIXELS];
+  static NullStrip nulls[STRIP_MAX];
+  static SegmentMap map;
+  static MultiStrip multi(map);
+  static uint16_t pixels;
+  for (uint8_t i = 0; i < STRIP_MAX; i++)
+    multi.attach(i, &nulls[i]);
+
+  const struct { uint16_t pixels; uint8_t strips; SegmentMode mode; } cases[] = {
+    { 144, 1, SEGMENT_INDEPENDENT }, { 300, 1, SEGMENT_INDEPENDENT }, { 600, 1, SEGMENT_INDEPENDENT },
+    { 300, 2, SEGMENT_INDEPENDENT }, { 600, 2, SEGMENT_INDEPENDENT }, { 600, 4, SEGMENT_INDEPENDENT },
+    { 144, 2, SEGMENT_MIRRORED },    { 300, 2, SEGMENT_MIRRORED },
+  };
+  for (const auto &c : cases) {
+    map.begin(c.pixels, c.strips, c.mode, 0x2);
+    pixels = c.pixels;
+    double ns = callNs(500, 100, [](int i) {
+      frame[i % pixels] = i;
+      multi.show(frame, pixels);
+    });
+    uint16_t longest = 0;
+    for (uint8_t s = 0; s < c.strips; s++)
+      if (map.segment(s).count > longest)
+        longest = map.segment(s).count;
+    const char *mode = c.mode == SEGMENT_MIRRORED ? "mirrored" : "independent";
+    printf("{\"scenario\":\"segments\",\"pixels\":%u,\"strips\":%u,\"mode\":\"%s\",\"ns_per_frame\":%.1f,\"wire_us\":%u}\n",
+           c.pixels, c.strips, mode, ns, longest * PIXEL_WIRE_US);
+    fprintf(stderr, "segments %3u px on %u %-11s strips: %.1f ns per frame, %u us on the wire\n",
+            c.pixels, c.strips, mode, ns, longest * PIXEL_WIRE_US);
+  }
+}
+
+
+// LedRenderer::render() of a changed frame at 50, 144 and 300 px with no
+// budget, under the budget (the sum only) and over it (sum and scale
+// pass), the cost of the limiter is the difference to the unlimited one.
+void benchLimiter() {
+  static NullStrip strip;
+  static LedRenderer leds(strip, LED_MAX_PIXELS, 0);
+  static uint32_t color;
+  leds.setBrightness(255);
+
+  const struct { const char *name; uint16_t budgetMa; uint32_t color; } cases[] = {
+    { "unlimited", 0, 0xffffff }, { "under", 60000, 0x4080ff }, { "over", 2000, 0xffffff },
+  };
+  for (uint16_t count : { 50, 144, 300 }) {
+    leds.setNumPixels(count);
+    double ns[3];
+    for (int c = 0; c < 3; c++) {
+      leds.setPowerBudget(cases[c].budgetMa);
+      color = cases[c].color;
+      leds.fill(color);
+      ns[c] = callNs(500, 20, [](int i) {
+        leds.set(0, color ^ (i & 1));     // a changed frame every time
+        leds.render(i);
+      });
+    }
+    printf("{\"scenario\":\"power_limit\",\"pixels\":%u,\"unlimited_ns\":%.1f,\"under_ns\":%.1f,\"over_ns\":%.1f}\n",
+           count, ns[0], ns[1], ns[2]);
+    fprintf(stderr, "power limit %3u px render %.1f ns unlimited, %.1f ns under budget, %.1f ns over\n",
+            count, ns[0], ns[1], ns[2]);
+  }
+}
+
+
+// the same symbols with a branch per bit
+static void naiveEncode(const uint32_t *frame, uint16_t count, uint32_t *symbols,
+                        uint32_t zero, uint32_t one) {
+  for (uint16_t i = 0; i < count; i++) {
+    uint8_t bytes[3] = { (uint8_t)(frame[i] >> 8), (uint8_t)(frame[i] >> 16), (uint8_t)frame[i] };
+    for (uint8_t b : bytes) {
+      for (uint8_t mask = 0x80; mask; mask >>= 1)
+        *symbols++ = (b & mask) ? one : zero;
+    }
+  }
+}
+
+
+// Ws2812Encoder::encode() of a random frame at 50, 144 and 300 px (the
+// work RmtStrip::show() does before the RMT takes over), against a branch
+// per bit. RmtStrip timings, random colors so the branches do not predict.
+void benchEncoder() {
+  static uint32_t frame[LED_MAX_PIXELS];
+  static uint32_t symbols[LED_MAX_PIXELS * WS2812_SYMBOLS_PER_PIXEL];
+  static Ws2812Encoder encoder(16, 34, 32, 18);
+  static uint16_t pixels;
+  for (uint16_t i = 0; i < LED_MAX_PIXELS; i++)
+    frame[i] = ((uint32_t)rand() << 8 ^ rand()) & 0xffffff;
+
+  for (uint16_t count : { 50, 144, 300 }) {
+    pixels = count;
+    double ns = callNs(500, 10, [](int i) {
+      encoder.encode(frame, pixels, symbols);
+      benchSink = symbols[i % (pixels * WS2812_SYMBOLS_PER_PIXEL)];
+    });
+    double naive = callNs(500, 10, [](int i) {
+      naiveEncode(frame, pixels, symbols, Ws2812Encoder::symbol(16, 34), Ws2812Encoder::symbol(32, 18));
+      benchSink = symbols[i % (pixels * WS2812_SYMBOLS_PER_PIXEL)];
+    });
+    printf("{\"scenario\":\"ws2812_encode\",\"pixels\":%u,\"ns_per_frame\":%.1f,\"naive_ns\":%.1f,\"wire_us\":%u}\n",
+           count, ns, naive, count * PIXEL_WIRE_US);
+    fprintf(stderr, "ws2812 encode %3u px %.1f ns per frame, branch per bit %.1f ns, %u us on the wire\n",
+            count, ns, naive, count * PIXEL_WIRE_US);
+  }
+}
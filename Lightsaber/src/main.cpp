@@ -1,218 +1,212 @@
 
 
 #include <Arduino.h>
-#include <SPIFFS.h>
-#include <EasyButton.h>
-#include <Adafruit_NeoPixel.h>
+#include <Wire.h>
 
 
 #include "AudioTools.h"
+#include "Saber.h"
+#include "EspHal.h"
+#include "RmtStrip.h"
+#include "Mpu6050.h"
+#include "BootSequencer.h"
+#include "ButtonInput.h"
+#include "SaberTrace.h"
+#include "Log.h"
+#include "Metrics.h"
+
+
+// The saber logic lives in lib/Saber and only sees the interfaces in
+// Hal.h, the same code runs on the host (src/native). This file wires it
+// to the ESP32 hardware and runs it in FreeRTOS tasks.
+
+// The button is read by a GPIO interrupt, gestures are decoded from the
+// edge timestamps so a busy loop() does not change what was pressed.
+#define BUTTON_PIN 10
 
+#define I2S_PIN_WS   25
+#define I2S_PIN_BCK  26
+#define I2S_PIN_DATA 27
 
-//
-// Never use a JsonDocument to store the configuration!
-// A JsonDocument is *not* a permanent storage; it's only a temporary storage
-// used during the serialization phase. See:
-// https://arduinojson.org/v6/faq/why-must-i-create-a-separate-config-object/
-struct Config {
-  char hostname[64];
-  int port;
-  char color[6];
-  int brightness;
-};
+ArduinoClock systemClock;
+EspFileSystem fileSystem;
+I2sSink audioSink(I2S_PIN_WS, I2S_PIN_BCK, I2S_PIN_DATA);
+ButtonInput button(BUTTON_PIN);
+Mpu6050 imu(Wire);
 
-const char *cfgfile = "/config.json";  // <- SD library uses 8.3 filenames
-Config cfg;                          // <- global configuration object
+// The strips are driven by the RMT peripheral, one channel each. Blade
+// length, strip count and pins come from the config.
+RmtStrip strips[STRIP_MAX] = { RmtStrip(0), RmtStrip(1), RmtStrip(2), RmtStrip(3) };
 
+void printLine(const char *line) {
+  Serial.println(line);
+}
 
-File audioFile;
-I2SStream i2s;                        // I2S stream 
-WAVDecoder decoder(i2s);              // decode wav to pcm and send it to I2S
-EncodedAudioStream out(i2s, decoder); // Decoder stream
-StreamCopy copier(out, audioFile); // copy url to decoder
+Saber saber({ systemClock, fileSystem, audioSink, { &strips[0], &strips[1], &strips[2], &strips[3] },
+              button, imu, printLine });
 
-// Arduino pin where the buttons are connected to.
-#define BUTTON_PIN 10
-// Instance of the button.
-EasyButton button(BUTTON_PIN);
-boolean bladeIsOn = false;
-
-
-// When setting up the NeoPixel library, we tell it how many pixels,
-// and which pin to use to send signals. Note that for older NeoPixel
-// strips you might need to change the third parameter -- see the
-// strandtest example for more information on possible values.
-// Which pin on the Arduino is connected to the NeoPixels?
-#define PIN        9 // On Trinket or Gemma, suggest changing this to 1
-// How many NeoPixels are attached to the Arduino?
-#define NUMPIXELS 50  // Popular NeoPixel ring size
-#define DURATION 1000 // Time (in milliseconds) to animate lightstrip
-
-Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_GRB + NEO_KHZ800);
-
-void playFile(const char * filename) {
-
-  // close the old file
-  audioFile.close();
-  // load the new one
-  audioFile = SPIFFS.open(filename, "r");
-
-  if (audioFile.available()) {
-    // setup I2S based on sampling rate provided by decoder
-//    out2dec.setNotifyAudioChange(i2s);
-    Serial.print("Start playing ");
-    Serial.println(filename);
-    i2s.begin();
-  } else {
-    Serial.println("failed to read sound file");
-  }
-}
 
+// The IMU is sampled at a fixed rate by its own task on core 1, swings and
+// clashes are posted to loop() through a lock-free queue.
+#define MOTION_CORE   1
+
+TaskHandle_t motionHandle;
 
-int prev;
-long startTime =0;
-
-void power(const char* sound, unsigned long duration, boolean reverse) {
-
-    Serial.printf("Start power(%s, %ul, %i\n", sound, duration, reverse);
-
-    unsigned long elapsed;
-    float fraction;
-    float threshold;
-    int num;
-
-    if (reverse)
-        prev = NUMPIXELS;
-    else
-        prev = 0;
-
-    if (startTime == 0) {               // nothing Playing ?
-      startTime = millis();             // Save audio start time
-      playFile(sound);                  // play sound
-    }
-
-    while (true) {
-      elapsed = millis() - startTime;   // Time spent playing sound
-      Serial.printf("elapsed %u starttime %u \n", elapsed, startTime);
-      if (elapsed > duration)           // Past sound duration?
-            break;                      // Stop animating
-
-      fraction = (float)elapsed / duration;            // Animation time, 0.0 to 1.0
-      if (reverse) {
-        fraction = 1.0 - fraction;            // 1.0 to 0.0 if reverse
-      };
-      fraction = pow(fraction, 0.5);       // Apply nonlinear curve
-      threshold = int(NUMPIXELS * fraction + 0.5);
-      num = threshold - prev;                   // Number of pixels to light on this pass
-
-      if (num == prev)                  // no changes -> break
-          break;
-
-      if (!reverse) {
-        for (int i=0; i<num; i++) {
-          pixels.setPixelColor(i, pixels.Color(0, 0, 20));
-        }
-      } else {
-        int poff =  NUMPIXELS+num;
-        for (int i=NUMPIXELS; i>=poff; i--) {
-          pixels.setPixelColor(i, pixels.Color(0, 0, 0));
-        }
-      } 
-      pixels.show();   // Send the updated pixel colors to the hardware.
-      copier.copy();
-    }
-
-    Serial.printf("end animation  %u starttime %u \n", elapsed, startTime);
-    while (copier.available()) {  //  # Wait until audio done
-         copier.copy(); 
-    }      
-
-    Serial.print("End Power");
-    if (reverse) {
-      pixels.clear();      // if there are any remaining pixels due to POV function
-      pixels.show();   // Send the updated pixel colors to the hardware.
-    }
-//    Serial.printf("power done (%s, %ul, %i\n", sound, duration, reverse);
-    startTime = 0;                    // reset startTime
+void motionTask(void *) {
+  TickType_t wake = xTaskGetTickCount();
+
+  while (true) {
+    saber.motionStep();
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(SABER_MOTION_PERIOD));
+  }
 }
 
 
-boolean isOn = false;
+// Audio runs on core 0 in two tasks: the mixer task sums all playing voices
+// into a lock-free PCM ring, the I2S task drains the ring into the I2S DMA
+// buffers. loop() on core 1 only posts play requests, so LED updates or
+// Serial output there can no longer starve I2S.
+#define AUDIO_CORE       0
 
-// Callback function to be called when the button is pressed.
-void onPressed()
-{
-    Serial.printf("Button pressed\n");
+TaskHandle_t mixerHandle;
+TaskHandle_t i2sHandle;
 
-    if (!isOn) {
-//      Serial.printf("Turn on Blade '%c' %s\n", config.color[0], config.color );
-      Serial.println("turn on blade ..");
-      power("/on.wav", 980, false);
-      Serial.print("turn on blade ..");
-      Serial.println("done ..");
-      isOn = true;     
-    }
+void mixerTask(void *) {
+  while (true) {
+    saber.mixStep();
+    vTaskDelay(1);      // let the I2S task drain the ring
+  }
 }
 
-// Callback function to be called when the button is pressed.
-void onPressedForDuration()
-{
-  Serial.println("Button long pressed");
-
-  if (isOn) {
-    Serial.println("Turn off Blade ..");
-    power("/off.wav", 930, true);
-    Serial.print("Turn off Blade ..");
-    Serial.println("done ..");
-    isOn = false;
+void i2sTask(void *) {
+  while (true) {
+    saber.audioStep();  // blocks until DMA has room
   }
-
 }
 
 
+// Deferred log records (Log.h) are printed by a low priority task on
+// core 0, the audio tasks preempt it whenever they need the CPU. Decode
+// the output with tools/log.
+#define LOG_CORE   0
+#define LOG_PERIOD 20           // ms between drains
 
-void setup() {
-// Init Serial output
-  Serial.begin(115200);
-  AudioLogger::instance().begin(Serial, AudioLogger::Info);  
+TaskHandle_t logHandle;
 
-// setup i2s
-  auto config = i2s.defaultConfig(TX_MODE);
-  config.pin_ws = 25;
-  config.pin_bck = 26;
-  config.pin_data = 27;
-  config.sample_rate = 16000; 
-  config.bits_per_sample = 32;
-  config.channels = 1;
-  i2s.begin(config);
+void logTask(void *) {
+  while (true) {
+    logBuffer.drain(printLine);
+    vTaskDelay(pdMS_TO_TICKS(LOG_PERIOD));
+  }
+}
 
-// mount SPIFF
-  SPIFFS.begin();
 
-// Initialize the button.
-  button.begin();
-  button.onPressed(onPressed);
-  button.onPressedFor(1000, onPressedForDuration);
+// init phases, timed by the boot sequencer. Audio and the sound bank are
+// lazy, the saber takes button input before they are up and the first
+// ignition brings them in.
+BootSequencer boot([]() -> uint32_t { return micros(); });
+int bootAudio;
 
+bool initSerial() {
+  Serial.begin(115200);
+  AudioLogger::instance().begin(Serial, AudioLogger::Warning);
+  logBuffer.begin([]() -> uint32_t { return millis(); });
+  xTaskCreatePinnedToCore(logTask, "log", 3072, nullptr, 1, &logHandle, LOG_CORE);
+  return true;
+}
 
- // init neopixel
-  pixels.begin(); // INITIALIZE NeoPixel strip object (REQUIRED)
+// motion sensing next to loop() on core 1
+bool initMotion() {
+  if (!saber.initMotion())
+    return false;
+  xTaskCreatePinnedToCore(motionTask, "motion", 4096, nullptr, 2, &motionHandle, MOTION_CORE);
+  return true;
+}
 
+// start audio on core 0, I2S writer above the mixer
+bool initAudio() {
+  if (!saber.initAudio())
+    return false;
+
+  // fill the ring before the I2S task starts draining it, it preempts the
+  // mixer and would otherwise find it empty: an underrun at every boot and
+  // pcm_low stuck at 0
+  saber.mixStep();
+  xTaskCreatePinnedToCore(mixerTask, "mixer", 8192, nullptr, 3, &mixerHandle, AUDIO_CORE);
+  xTaskCreatePinnedToCore(i2sTask, "i2s", 4096, nullptr, 5, &i2sHandle, AUDIO_CORE);
+  return true;
+}
 
+// bring up audio on first use and print how long that took
+void ensureAudio() {
+  if (boot.state(bootAudio) != BootSequencer::PENDING)
+    return;
+  boot.ensure(bootAudio);
+  boot.report(printLine);
 }
 
 
-void loop() {
-  // put your main code here, to run repeatedly:
+void setup() {
+  int serial = boot.add("serial", initSerial);
+  int config = boot.add("config", []() { return saber.initConfig(); }, 1u << serial);
+  boot.add("button", []() { return saber.initButton(); }, 1u << serial);
+  boot.add("strip", []() { return saber.initStrip(); }, 1u << config);
+  boot.add("motion", initMotion, 1u << serial);
+  int soundBank = boot.add("soundbank", []() { return saber.initSoundBank(); }, 1u << serial, true);
+  bootAudio = boot.add("audio", initAudio, 1u << soundBank, true);
+  saber.setIgniteHook(ensureAudio);
+
+  boot.run();
+  boot.report(printLine);
+}
+
 
-    // Continuously read the status of the button.
-  button.read();
+// Heap and stack headroom are sampled when the metrics line is asked for,
+// the saber keeps its own metrics up to date. Stacks show the bytes never
+// touched since the task started, a task that is not up shows 0.
+int heapMetric = metrics.add("heap_min", METRIC_GAUGE);
+int stackLoopMetric = metrics.add("stack_loop", METRIC_GAUGE);
+int stackMotionMetric = metrics.add("stack_motion", METRIC_GAUGE);
+int stackMixerMetric = metrics.add("stack_mixer", METRIC_GAUGE);
+int stackI2sMetric = metrics.add("stack_i2s", METRIC_GAUGE);
+int stackLogMetric = metrics.add("stack_log", METRIC_GAUGE);
 
-  copier.copy();
+uint32_t stackLeft(TaskHandle_t task) {
+  return task ? uxTaskGetStackHighWaterMark(task) : 0;
+}
+
+void printMetrics() {
+  static MetricsSnapshot previous;
+  static bool havePrevious = false;
+  MetricsSnapshot snapshot;
+  char line[384];
+
+  metrics.set(heapMetric, ESP.getMinFreeHeap());
+  metrics.set(stackLoopMetric, uxTaskGetStackHighWaterMark(nullptr));
+  metrics.set(stackMotionMetric, stackLeft(motionHandle));
+  metrics.set(stackMixerMetric, stackLeft(mixerHandle));
+  metrics.set(stackI2sMetric, stackLeft(i2sHandle));
+  metrics.set(stackLogMetric, stackLeft(logHandle));
+
+  metrics.snapshot(snapshot, millis());
+  metrics.format(snapshot, havePrevious ? &previous : nullptr, line, sizeof(line));
+  printLine(line);
+  previous = snapshot;
+  havePrevious = true;
+}
 
-  // no file loaded play random hum sounds
-  if (isOn && !copier.available()) {
-    playFile("/Hum-4.wav");
+// one letter commands over serial: t dumps the trace ring (tools/trace),
+// m prints the metrics line, rates since the previous m
+void handleSerial() {
+  switch (Serial.read()) {
+    case 't': traceRing.dump(printLine, saberTraceNames, TRACE_IDS); break;
+    case 'm': printMetrics(); break;
   }
+}
 
-}
\ No newline at end of file
+
+void loop() {
+  saber.loop();
+  if (Serial.available())
+    handleSerial();
+}
@@ -0,0 +1,71 @@
+//
+// The saber on Linux: pio run -e native, then
+//   .pio/build/native/program [data dir] [out.wav] [seconds] [trace.log]
+//
+// Runs the firmware loop in a Simulation (lib/Sim) against the host HAL
+// with a virtual clock, as fast as the host can. The partitions are read
+// from <data>/config.bin and <data>/soundbank.bin (tools/config,
+// tools/soundbank), config.json is the fallback. A fixed script clicks
+// the button, the audio goes to out.wav if given, the trace ring of the
+// last moments to trace.log (tools/trace converts it). The report ends
+// with the metrics line (Metrics.h). Built with frame pointers, so
+//   perf record -g .pio/build/native/program
+// shows where the firmware spends its time.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "Simulation.h"
+#include "SaberTrace.h"
+#include "Metrics.h"
+
+
+static FILE *traceFile;
+
+
+int main(int argc, char **argv) {
+  const char *dataDir = argc > 1 ? argv[1] : "data";
+  const char *wavPath = argc > 2 ? argv[2] : nullptr;
+  uint32_t seconds = argc > 3 ? atoi(argv[3]) : 20;
+  const char *tracePath = argc > 4 ? argv[4] : nullptr;
+
+  static Simulation sim(dataDir, wavPath);
+  sim.begin();
+
+  // every 10 s: click on, double click to the next profile, hold off
+  for (uint32_t t = 0; t + 10000 <= seconds * 1000; t += 10000) {
+    sim.button.press(t + 500, 80);
+    sim.button.press(t + 3000, 80);
+    sim.button.press(t + 3200, 80);
+    sim.button.press(t + 7000, 900);
+  }
+
+  static MetricsSnapshot before, after;
+  metrics.snapshot(before, sim.clock.millis());
+
+  auto start = std::chrono::steady_clock::now();
+  sim.run(seconds * 1000);
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  sim.audio().close();
+
+  if (tracePath && (traceFile = fopen(tracePath, "w"))) {
+    traceRing.dump([](const char *line) { fprintf(traceFile, "%s\n", line); }, saberTraceNames, TRACE_IDS);
+    fclose(traceFile);
+  }
+
+  const LedRenderer &leds = sim.saber().leds();
+  printf("%u s simulated in %.3f s (%.0fx real time)\n", seconds, wall, seconds / wall);
+  printf("frames %u sent, %u skipped, strip 0 got %u\n", leds.framesRendered(),
+         leds.framesSkipped(), sim.strips[0].frames());
+  printf("audio %llu samples, %u underruns\n", (unsigned long long)sim.audio().samples(),
+         sim.saber().audioUnderruns());
+
+  // the line the device prints for 'm', rates over the whole run
+  char line[384];
+  metrics.snapshot(after, sim.clock.millis());
+  metrics.format(after, &before, line, sizeof(line));
+  printf("%s\n", line);
+  return 0;
+}
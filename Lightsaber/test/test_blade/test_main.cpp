@@ -0,0 +1,114 @@
+//
+// Blade state machine against a fake clock: ignition and retraction
+// timing, state changes and frame requests.
+//
+
+#include <unity.h>
+
+#include "Blade.h"
+
+#define PIXELS 50
+
+
+void setUp() {}
+void tearDown() {}
+
+
+void test_ignition_timing() {
+  Blade blade(PIXELS);
+  TEST_ASSERT_TRUE(blade.ignite(1000, 980));
+  TEST_ASSERT_EQUAL(BLADE_IGNITING, blade.state());
+
+  // sqrt curve: half way through the time, 71% of the blade is lit
+  blade.update(1490);
+  TEST_ASSERT_INT_WITHIN(1, 35, blade.lit());
+  TEST_ASSERT_TRUE(blade.busy());
+
+  blade.update(1979);
+  TEST_ASSERT_EQUAL(BLADE_IGNITING, blade.state());
+  blade.update(1980);
+  TEST_ASSERT_EQUAL(BLADE_ON, blade.state());
+  TEST_ASSERT_EQUAL(PIXELS, blade.lit());
+}
+
+void test_lit_grows_every_frame() {
+  Blade blade(PIXELS);
+  blade.ignite(0, 500, CURVE_EASE_IN_OUT);
+  uint16_t last = 0;
+  for (uint32_t t = 0; t <= 500; t += 10) {
+    blade.update(t);
+    TEST_ASSERT_GREATER_OR_EQUAL(last, blade.lit());
+    last = blade.lit();
+  }
+  TEST_ASSERT_EQUAL(PIXELS, last);
+}
+
+void test_retraction_runs_the_curve_backwards() {
+  Blade on(PIXELS), off(PIXELS);
+  on.ignite(0, 1000);
+  on.update(300);
+  off.ignite(0, 1);
+  off.update(1);
+  off.retract(5000, 1000);
+  off.update(5700);
+  TEST_ASSERT_EQUAL(on.lit(), off.lit());
+
+  off.update(6000);
+  TEST_ASSERT_EQUAL(BLADE_OFF, off.state());
+  TEST_ASSERT_EQUAL(0, off.lit());
+}
+
+void test_update_reports_changes_only() {
+  Blade blade(PIXELS);
+  TEST_ASSERT_FALSE(blade.update(0));
+  blade.ignite(0, 1000);
+  TEST_ASSERT_TRUE(blade.update(100));
+  TEST_ASSERT_FALSE(blade.update(100));
+  TEST_ASSERT_TRUE(blade.update(1000));
+  TEST_ASSERT_FALSE(blade.update(2000));
+}
+
+void test_commands_only_in_matching_state() {
+  Blade blade(PIXELS);
+  TEST_ASSERT_FALSE(blade.retract(0, 100));
+  TEST_ASSERT_TRUE(blade.ignite(0, 100));
+  TEST_ASSERT_FALSE(blade.ignite(10, 100));
+  TEST_ASSERT_FALSE(blade.retract(10, 100));
+  TEST_ASSERT_FALSE(blade.setNumPixels(10));
+  blade.update(100);
+  TEST_ASSERT_TRUE(blade.retract(200, 100));
+  blade.update(300);
+  TEST_ASSERT_TRUE(blade.isOff());
+  TEST_ASSERT_TRUE(blade.setNumPixels(10));
+}
+
+void test_clock_wrap() {
+  Blade blade(PIXELS);
+  uint32_t start = UINT32_MAX - 100;
+  blade.ignite(start, 200);
+  blade.update(start + 100);
+  TEST_ASSERT_EQUAL(BLADE_IGNITING, blade.state());
+  TEST_ASSERT_INT_WITHIN(1, 35, blade.lit());
+  blade.update(start + 200);
+  TEST_ASSERT_EQUAL(BLADE_ON, blade.state());
+}
+
+void test_zero_duration() {
+  Blade blade(PIXELS);
+  blade.ignite(10, 0);
+  blade.update(11);
+  TEST_ASSERT_TRUE(blade.isOn());
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ignition_timing);
+  RUN_TEST(test_lit_grows_every_frame);
+  RUN_TEST(test_retraction_runs_the_curve_backwards);
+  RUN_TEST(test_update_reports_changes_only);
+  RUN_TEST(test_commands_only_in_matching_state);
+  RUN_TEST(test_clock_wrap);
+  RUN_TEST(test_zero_duration);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+//
+// BootSequencer with fake phases on a fake clock: dependency order, lazy
+// phases, failures and the report.
+//
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unity.h>
+
+#include "BootSequencer.h"
+
+static uint32_t now;
+static std::string order;
+static std::vector<std::string> lines;
+
+static uint32_t fakeClock() { return now; }
+
+// every phase takes 100 us and appends its letter
+template <char Name, bool Ok = true>
+static bool phase() {
+  order += Name;
+  now += 100;
+  return Ok;
+}
+
+static void collect(const char *line) { lines.push_back(line); }
+
+
+void setUp() {
+  now = 5000;
+  order.clear();
+  lines.clear();
+}
+
+void tearDown() {}
+
+
+// dependencies run first, whatever order the phases were added in
+void test_dependency_order() {
+  BootSequencer boot(fakeClock);
+  int c = boot.add("c", phase<'c'>, 1u << 1 | 1u << 2);
+  int a = boot.add("a", phase<'a'>);
+  int b = boot.add("b", phase<'b'>, 1u << 1);
+  TEST_ASSERT_EQUAL(0, c);
+  TEST_ASSERT_TRUE(boot.run());
+  TEST_ASSERT_EQUAL_STRING("abc", order.c_str());
+  TEST_ASSERT_TRUE(boot.done(a) && boot.done(b) && boot.done(c));
+}
+
+// lazy phases wait for ensure(), which also pulls in what they need once
+void test_lazy_phase() {
+  BootSequencer boot(fakeClock);
+  int fs = boot.add("fs", phase<'f'>, 0, true);
+  int config = boot.add("config", phase<'c'>);
+  int audio = boot.add("audio", phase<'a'>, 1u << fs, true);
+  TEST_ASSERT_TRUE(boot.run());
+  TEST_ASSERT_EQUAL_STRING("c", order.c_str());
+  TEST_ASSERT_EQUAL(BootSequencer::PENDING, boot.state(audio));
+  TEST_ASSERT_EQUAL(BootSequencer::PENDING, boot.state(fs));
+
+  TEST_ASSERT_TRUE(boot.ensure(audio));
+  TEST_ASSERT_TRUE(boot.ensure(audio));
+  TEST_ASSERT_EQUAL_STRING("cfa", order.c_str());
+  TEST_ASSERT_TRUE(boot.done(config));
+}
+
+// a failed phase skips its dependents and is not retried
+void test_failure_skips_dependents() {
+  BootSequencer boot(fakeClock);
+  int fs = boot.add("fs", phase<'f', false>);
+  int config = boot.add("config", phase<'c'>, 1u << fs);
+  int button = boot.add("button", phase<'b'>);
+  TEST_ASSERT_FALSE(boot.run());
+  TEST_ASSERT_EQUAL_STRING("fb", order.c_str());
+  TEST_ASSERT_EQUAL(BootSequencer::FAILED, boot.state(fs));
+  TEST_ASSERT_EQUAL(BootSequencer::SKIPPED, boot.state(config));
+  TEST_ASSERT_TRUE(boot.done(button));
+  TEST_ASSERT_FALSE(boot.ensure(config));
+  TEST_ASSERT_EQUAL_STRING("fb", order.c_str());
+}
+
+void test_cycle_fails() {
+  BootSequencer boot(fakeClock);
+  boot.add("a", phase<'a'>, 1u << 1);
+  boot.add("b", phase<'b'>, 1u << 0);
+  TEST_ASSERT_FALSE(boot.run());
+  TEST_ASSERT_EQUAL_STRING("", order.c_str());
+}
+
+void test_table_full() {
+  BootSequencer boot(fakeClock);
+  for (int i = 0; i < BOOT_MAX_PHASES; i++)
+    TEST_ASSERT_EQUAL(i, boot.add("x", nullptr));
+  TEST_ASSERT_EQUAL(-1, boot.add("x", nullptr));
+  TEST_ASSERT_FALSE(boot.ensure(BOOT_MAX_PHASES));
+  TEST_ASSERT_FALSE(boot.ensure(-1));
+}
+
+// start times from the first phase, durations on the fake clock
+void test_report() {
+  BootSequencer boot(fakeClock);
+  boot.add("fs", phase<'f'>);
+  boot.add("config", phase<'c'>, 1u << 0);
+  boot.add("audio", phase<'a'>, 0, true);
+  boot.run();
+  boot.report(collect);
+
+  TEST_ASSERT_EQUAL(5, lines.size());
+  char expect[64];
+  snprintf(expect, sizeof(expect), "%-12s %10u %10u  ok", "fs", 0, 100);
+  TEST_ASSERT_EQUAL_STRING(expect, lines[1].c_str());
+  snprintf(expect, sizeof(expect), "%-12s %10u %10u  ok", "config", 100, 100);
+  TEST_ASSERT_EQUAL_STRING(expect, lines[2].c_str());
+  snprintf(expect, sizeof(expect), "%-12s %10s %10s  lazy", "audio", "-", "-");
+  TEST_ASSERT_EQUAL_STRING(expect, lines[3].c_str());
+  snprintf(expect, sizeof(expect), "%-12s %10s %10u", "total", "", 200);
+  TEST_ASSERT_EQUAL_STRING(expect, lines[4].c_str());
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_dependency_order);
+  RUN_TEST(test_lazy_phase);
+  RUN_TEST(test_failure_skips_dependents);
+  RUN_TEST(test_cycle_fails);
+  RUN_TEST(test_table_full);
+  RUN_TEST(test_report);
+  return UNITY_END();
+}
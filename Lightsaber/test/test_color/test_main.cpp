@@ -0,0 +1,120 @@
+//
+// Packed color math against plain per channel arithmetic, and the gamma /
+// brightness lookup table.
+//
+
+#include <math.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#include "Color.h"
+
+static uint8_t channel(uint32_t color, int shift) { return color >> shift & 0xff; }
+
+static uint32_t random24() { return ((uint32_t)rand() << 8 ^ rand()) & 0xffffff; }
+
+
+void setUp() { srand(1); }
+void tearDown() {}
+
+
+void test_rgb() {
+  TEST_ASSERT_EQUAL_HEX32(0x123456, rgb(0x12, 0x34, 0x56));
+}
+
+// every channel value at every scale, next to random other channels
+void test_scale_matches_per_channel() {
+  for (uint32_t scale = 0; scale <= 256; scale++) {
+    for (uint32_t v = 0; v < 256; v++) {
+      uint32_t other = random24();
+      for (int shift = 0; shift < 24; shift += 8) {
+        uint32_t c = (other & ~(0xffu << shift)) | v << shift;
+        uint32_t out = scaleColor(c, scale);
+        for (int s = 0; s < 24; s += 8)
+          TEST_ASSERT_EQUAL(channel(c, s) * scale >> 8, channel(out, s));
+      }
+    }
+  }
+}
+
+void test_blend_matches_per_channel() {
+  for (int i = 0; i < 200000; i++) {
+    uint32_t dst = random24(), src = random24();
+    uint16_t alpha = rand() % 257;
+    uint32_t out = blendColor(dst, src, alpha);
+    for (int s = 0; s < 24; s += 8)
+      TEST_ASSERT_EQUAL((channel(src, s) * alpha + channel(dst, s) * (256 - alpha)) >> 8, channel(out, s));
+  }
+  TEST_ASSERT_EQUAL_HEX32(0xffffff, blendColor(0, 0xffffff, 256));
+  TEST_ASSERT_EQUAL_HEX32(0x123456, blendColor(0x123456, 0xffffff, 0));
+}
+
+void test_add_saturates() {
+  for (int i = 0; i < 200000; i++) {
+    uint32_t a = random24(), b = random24();
+    uint32_t out = addColor(a, b);
+    for (int s = 0; s < 24; s += 8) {
+      uint32_t sum = channel(a, s) + channel(b, s);
+      TEST_ASSERT_EQUAL(sum > 255 ? 255 : sum, channel(out, s));
+    }
+  }
+  TEST_ASSERT_EQUAL_HEX32(0xff00ff, addColor(0x800080, 0x800080));
+  TEST_ASSERT_EQUAL_HEX32(0x00ff00, addColor(0x00ff00, 0x000100) & 0x00ff00);
+}
+
+// the constexpr table against pow(x, 2.5)
+void test_gamma_table() {
+  TEST_ASSERT_EQUAL(0, colorGamma::table.v[0]);
+  TEST_ASSERT_EQUAL(COLOR_GAMMA_ONE, colorGamma::table.v[255]);
+  for (int i = 1; i < 256; i++) {
+    TEST_ASSERT_TRUE(colorGamma::table.v[i] >= colorGamma::table.v[i - 1]);
+    double expect = pow(i / 255.0, 2.5) * COLOR_GAMMA_ONE;
+    TEST_ASSERT_FLOAT_WITHIN(0.51, expect, colorGamma::table.v[i]);
+  }
+}
+
+// gamma then brightness, rounded, one lookup per channel
+void test_lut() {
+  ColorLut lut;
+  TEST_ASSERT_EQUAL(255, lut.brightness());
+  TEST_ASSERT_EQUAL_HEX32(0xff0000, lut.map(0xff0000));
+  TEST_ASSERT_EQUAL_HEX32(0, lut.map(0));
+
+  for (int brightness = 0; brightness < 256; brightness += 5) {
+    lut.setBrightness(brightness);
+    uint32_t last = 0;
+    for (uint32_t v = 0; v < 256; v++) {
+      uint32_t out = lut.map(v << 16 | v << 8 | v);
+      double expect = pow(v / 255.0, 2.5) * 255 * (brightness + 1) / 256;
+      TEST_ASSERT_INT_WITHIN(1, (int)(expect + 0.5), out & 0xff);
+      TEST_ASSERT_EQUAL(out & 0xff, out >> 8 & 0xff);
+      TEST_ASSERT_EQUAL(out & 0xff, out >> 16);
+      TEST_ASSERT_TRUE((out & 0xff) >= last);
+      last = out & 0xff;
+    }
+  }
+}
+
+void test_lut_apply() {
+  ColorLut lut;
+  uint32_t in[300], out[300];
+  lut.setBrightness(90);
+  for (int i = 0; i < 300; i++)
+    in[i] = random24();
+  lut.apply(in, out, 300);
+  for (int i = 0; i < 300; i++)
+    TEST_ASSERT_EQUAL_HEX32(lut.map(in[i]), out[i]);
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_rgb);
+  RUN_TEST(test_scale_matches_per_channel);
+  RUN_TEST(test_blend_matches_per_channel);
+  RUN_TEST(test_add_saturates);
+  RUN_TEST(test_gamma_table);
+  RUN_TEST(test_lut);
+  RUN_TEST(test_lut_apply);
+  return UNITY_END();
+}
@@ -0,0 +1,115 @@
+//
+// Envelope follower: RMS and peak of known blocks, attack and release.
+//
+
+#include <math.h>
+#include <unity.h>
+
+#include "Envelope.h"
+
+#define BLOCK 256
+
+static int32_t block[BLOCK];
+
+// I2S samples as the Mixer writes them, 16 bit audio in the upper half
+static void sine(double amplitude) {
+  for (int i = 0; i < BLOCK; i++)
+    block[i] = (int32_t)(amplitude * 32767 * sin(2 * M_PI * i / 32)) * 65536;
+}
+
+static void fill(int32_t sample) {
+  for (int i = 0; i < BLOCK; i++)
+    block[i] = sample;
+}
+
+// blocks until the level gets past threshold, counting up or down
+static int blocksUntil(Envelope &envelope, uint16_t threshold, bool rising) {
+  for (int n = 1; n < 1000; n++) {
+    envelope.process(block, BLOCK);
+    if (rising ? envelope.level() >= threshold : envelope.level() <= threshold)
+      return n;
+  }
+  return -1;
+}
+
+
+void setUp() {}
+void tearDown() {}
+
+
+void test_silence() {
+  Envelope envelope;
+  fill(0);
+  envelope.process(block, BLOCK);
+  TEST_ASSERT_EQUAL(0, envelope.level());
+  TEST_ASSERT_EQUAL(0, envelope.peak());
+}
+
+// a sine settles at amplitude / sqrt(2), the peak is the amplitude
+void test_sine_rms_and_peak() {
+  Envelope envelope;
+  sine(0.5);
+  for (int i = 0; i < 50; i++)
+    envelope.process(block, BLOCK);
+  TEST_ASSERT_INT_WITHIN(300, (int)(0.5 * ENVELOPE_ONE / sqrt(2)), envelope.level());
+  TEST_ASSERT_INT_WITHIN(100, ENVELOPE_ONE / 2, envelope.peak());
+}
+
+void test_full_scale() {
+  Envelope envelope;
+  fill(INT32_MIN);
+  for (int i = 0; i < 50; i++)
+    envelope.process(block, BLOCK);
+  TEST_ASSERT_INT_WITHIN(32, ENVELOPE_ONE, envelope.level());
+  TEST_ASSERT_EQUAL(ENVELOPE_ONE, envelope.peak());
+}
+
+// blocks far past 1024 samples of full scale, where a 32 bit square sum
+// would wrap around
+void test_long_full_scale_block() {
+  static int32_t longBlock[16 * BLOCK];
+  for (int32_t &s : longBlock)
+    s = INT32_MIN;
+  const size_t counts[] = { 1023, 1024, 4096, 16 * BLOCK };
+  for (size_t count : counts) {
+    Envelope envelope;
+    for (int i = 0; i < 50; i++)
+      envelope.process(longBlock, count);
+    TEST_ASSERT_INT_WITHIN(32, ENVELOPE_ONE, envelope.level());
+    TEST_ASSERT_EQUAL(ENVELOPE_ONE, envelope.peak());
+  }
+}
+
+// the blade reacts to a clash within a few blocks and fades out slowly
+void test_attack_faster_than_release() {
+  Envelope envelope;
+  sine(1.0);
+  int attack = blocksUntil(envelope, ENVELOPE_ONE * 0.9 / sqrt(2), true);
+  fill(0);
+  int release = blocksUntil(envelope, ENVELOPE_ONE * 0.1 / sqrt(2), false);
+
+  TEST_ASSERT_GREATER_THAN(0, attack);
+  TEST_ASSERT_LESS_OR_EQUAL(4, attack);
+  TEST_ASSERT_GREATER_THAN(4 * attack, release);
+}
+
+void test_empty_block_keeps_the_level() {
+  Envelope envelope;
+  sine(1.0);
+  envelope.process(block, BLOCK);
+  uint16_t level = envelope.level();
+  envelope.process(block, 0);
+  TEST_ASSERT_EQUAL(level, envelope.level());
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_silence);
+  RUN_TEST(test_sine_rms_and_peak);
+  RUN_TEST(test_full_scale);
+  RUN_TEST(test_long_full_scale_block);
+  RUN_TEST(test_attack_faster_than_release);
+  RUN_TEST(test_empty_block_keeps_the_level);
+  return UNITY_END();
+}
@@ -0,0 +1,187 @@
+//
+// GestureRecognizer on edge timing traces: the four gestures, the limits
+// between them, bounces and glitches, and the same result whether update()
+// runs every ms or only once at the end.
+//
+
+#include <stdlib.h>
+#include <vector>
+#include <unity.h>
+
+#include "GestureRecognizer.h"
+
+typedef std::vector<ButtonEdge> Trace;
+
+// a clean press from 'time' for 'length' ms
+static void press(Trace &trace, uint32_t time, uint32_t length) {
+  trace.push_back({ time, true });
+  trace.push_back({ time + length, false });
+}
+
+// the gestures of a trace up to 'until', update() every 'every' ms (0: only
+// with the edges and once at the end)
+static std::vector<Gesture> decode(const Trace &trace, uint32_t until, uint32_t every = 1) {
+  GestureRecognizer recognizer;
+  std::vector<Gesture> out;
+  Gesture gesture;
+  size_t next = 0;
+
+  for (uint32_t now = 0; now <= until; now++) {
+    while (next < trace.size() && trace[next].time <= now)
+      recognizer.edge(trace[next++]);
+    if (every == 0 ? now == until : now % every == 0)
+      recognizer.update(now);
+    while (recognizer.pop(gesture))
+      out.push_back(gesture);
+  }
+  return out;
+}
+
+static void expect(const std::vector<Gesture> &got, uint8_t type, uint32_t time) {
+  TEST_ASSERT_EQUAL(1, got.size());
+  TEST_ASSERT_EQUAL(type, got[0].type);
+  TEST_ASSERT_EQUAL(time, got[0].time);
+}
+
+
+void setUp() {}
+void tearDown() {}
+
+
+// a click is reported once the double click gap is over
+void test_click() {
+  Trace trace;
+  press(trace, 100, 100);
+  expect(decode(trace, 1000), GESTURE_CLICK, 200 + 250);
+  TEST_ASSERT_EQUAL(0, decode(trace, 449).size());
+}
+
+void test_double_click() {
+  Trace trace;
+  press(trace, 100, 100);
+  press(trace, 400, 100);
+  expect(decode(trace, 2000), GESTURE_DOUBLE_CLICK, 500);
+
+  // one ms more of gap makes it two clicks
+  Trace apart;
+  press(apart, 100, 100);
+  press(apart, 451, 100);
+  std::vector<Gesture> got = decode(apart, 2000);
+  TEST_ASSERT_EQUAL(2, got.size());
+  TEST_ASSERT_EQUAL(GESTURE_CLICK, got[0].type);
+  TEST_ASSERT_EQUAL(GESTURE_CLICK, got[1].type);
+}
+
+// reported while the button is still down
+void test_hold() {
+  Trace trace;
+  press(trace, 100, 2000);
+  expect(decode(trace, 901), GESTURE_HOLD, 900);
+  expect(decode(trace, 3000), GESTURE_HOLD, 900);
+}
+
+void test_hold_click() {
+  Trace trace;
+  press(trace, 100, 100);
+  press(trace, 300, 1000);
+  expect(decode(trace, 3000), GESTURE_HOLD_CLICK, 1100);
+}
+
+// too long for a click, too short for a hold
+void test_long_press_is_nothing() {
+  Trace trace;
+  press(trace, 100, 350);
+  TEST_ASSERT_EQUAL(0, decode(trace, 3000).size());
+  press(trace, 1000, 349);
+  expect(decode(trace, 3000), GESTURE_CLICK, 1349 + 250);
+}
+
+// contact bounce on both edges is one click at the clean times
+void test_bounces() {
+  Trace trace = {
+    { 100, true }, { 102, false }, { 105, true }, { 107, false }, { 109, true },
+    { 200, false }, { 203, true }, { 204, false },
+  };
+  GestureRecognizer recognizer;
+  recognizer.edge(trace[0]);
+  TEST_ASSERT_TRUE(recognizer.pressed());
+  recognizer.edge(trace[1]);
+  TEST_ASSERT_TRUE(recognizer.pressed());
+  expect(decode(trace, 1000), GESTURE_CLICK, 200 + 250);
+}
+
+// a bounce that leaves the button released counts once it is stable
+void test_bounce_settles_released() {
+  Trace trace = { { 100, true }, { 300, false }, { 310, true }, { 315, false } };
+  expect(decode(trace, 1000), GESTURE_CLICK, 300 + 250);
+}
+
+// a press shorter than the debounce time
+void test_glitch_ignored() {
+  Trace trace;
+  press(trace, 100, 5);
+  press(trace, 200, 19);
+  TEST_ASSERT_EQUAL(0, decode(trace, 2000).size());
+
+  // a glitch after a click keeps waiting for the second press
+  Trace after;
+  press(after, 100, 100);
+  press(after, 300, 10);
+  press(after, 400, 100);
+  expect(decode(after, 2000), GESTURE_DOUBLE_CLICK, 500);
+}
+
+// a busy caller decodes the same gestures at the same times
+void test_late_update() {
+  srand(7);
+  for (int round = 0; round < 100; round++) {
+    Trace trace;
+    uint32_t t = 50;
+    for (int i = 0; i < 12; i++) {
+      uint32_t length = 5 + rand() % 1200;
+      press(trace, t, length);
+      t += length + 5 + rand() % 600;
+    }
+    std::vector<Gesture> prompt = decode(trace, t + 2000);
+    for (uint32_t every : { 0u, 37u }) {
+      std::vector<Gesture> late = decode(trace, t + 2000, every);
+      TEST_ASSERT_EQUAL(prompt.size(), late.size());
+      for (size_t i = 0; i < prompt.size(); i++) {
+        TEST_ASSERT_EQUAL(prompt[i].type, late[i].type);
+        TEST_ASSERT_EQUAL(prompt[i].time, late[i].time);
+      }
+    }
+  }
+}
+
+// nobody pops, the oldest gestures stay
+void test_queue_full() {
+  GestureRecognizer recognizer;
+  for (uint32_t i = 0; i < GESTURE_QUEUE + 2; i++) {
+    recognizer.edge({ 1000 * i + 100, true });
+    recognizer.edge({ 1000 * i + 200, false });
+  }
+  recognizer.update(100000);
+  Gesture gesture;
+  for (uint32_t i = 0; i < GESTURE_QUEUE; i++) {
+    TEST_ASSERT_TRUE(recognizer.pop(gesture));
+    TEST_ASSERT_EQUAL(1000 * i + 450, gesture.time);
+  }
+  TEST_ASSERT_FALSE(recognizer.pop(gesture));
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_click);
+  RUN_TEST(test_double_click);
+  RUN_TEST(test_hold);
+  RUN_TEST(test_hold_click);
+  RUN_TEST(test_long_press_is_nothing);
+  RUN_TEST(test_bounces);
+  RUN_TEST(test_bounce_settles_released);
+  RUN_TEST(test_glitch_ignored);
+  RUN_TEST(test_late_update);
+  RUN_TEST(test_queue_full);
+  return UNITY_END();
+}
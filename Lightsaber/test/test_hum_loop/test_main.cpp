@@ -0,0 +1,113 @@
+//
+// HumLoop: the loop point of a hum that does not end on a whole period,
+// read in uneven blocks over several loops.
+//
+
+#include <math.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#include "HumLoop.h"
+#include "MemoryPcm.h"
+
+#define HUM_LENGTH 10000
+#define HUM_PERIOD 100.7    // samples, the hum ends mid period
+#define HUM_LEVEL  8000     // DC offset, so silence shows up as a step
+#define HUM_SWING  6000
+#define XFADE      512
+
+static int16_t hum[HUM_LENGTH];
+static int maxStep;         // largest sample to sample step inside the hum
+
+
+void setUp() {
+  maxStep = 0;
+  for (int i = 0; i < HUM_LENGTH; i++) {
+    hum[i] = (int16_t)(HUM_LEVEL + HUM_SWING * sin(2 * M_PI * i / HUM_PERIOD));
+    if (i > 0 && abs(hum[i] - hum[i - 1]) > maxStep)
+      maxStep = abs(hum[i] - hum[i - 1]);
+  }
+}
+
+void tearDown() {}
+
+
+// the sound as is has a jump at the loop point, the test would see it
+void test_hum_has_a_click_when_looped_plainly() {
+  TEST_ASSERT_GREATER_THAN(4 * maxStep, abs(hum[0] - hum[HUM_LENGTH - 1]));
+}
+
+void test_no_gap_or_click_at_the_loop_point() {
+  MemoryPcm pcm;
+  HumLoop loop;
+  pcm.begin(hum, HUM_LENGTH);
+  TEST_ASSERT_TRUE(loop.begin(pcm, XFADE));
+  TEST_ASSERT_EQUAL(HUM_LENGTH - XFADE, loop.length());
+
+  int16_t block[700];
+  int16_t last = 0;
+  uint32_t total = 0;
+  for (int b = 0; total < 5 * HUM_LENGTH; b++) {
+    size_t count = 1 + (b * 257) % 700;
+    TEST_ASSERT_EQUAL(count, loop.read(block, count));
+    for (size_t i = 0; i < count; i++, total++) {
+      TEST_ASSERT_GREATER_THAN(HUM_LEVEL - HUM_SWING - 100, block[i]);
+      if (total > 0)
+        TEST_ASSERT_LESS_OR_EQUAL(maxStep + 20, abs(block[i] - last));
+      last = block[i];
+    }
+  }
+}
+
+// after the first loop every period is the same
+void test_loop_is_periodic() {
+  MemoryPcm pcm;
+  HumLoop loop;
+  pcm.begin(hum, HUM_LENGTH);
+  loop.begin(pcm, XFADE);
+
+  static int16_t out[3 * HUM_LENGTH];
+  TEST_ASSERT_EQUAL(3 * HUM_LENGTH, loop.read(out, 3 * HUM_LENGTH));
+  uint32_t period = loop.length();
+  for (uint32_t i = period; i < 2 * period; i++)
+    TEST_ASSERT_EQUAL_INT16(out[i], out[i + period]);
+  // the body plays untouched
+  TEST_ASSERT_EQUAL_MEMORY(hum + XFADE, out + period + XFADE, (period - XFADE) * sizeof(int16_t));
+}
+
+void test_seek_into_the_head() {
+  MemoryPcm pcm;
+  HumLoop loop;
+  pcm.begin(hum, HUM_LENGTH);
+  loop.begin(pcm, XFADE);
+
+  int16_t out[XFADE * 2];
+  TEST_ASSERT_TRUE(loop.seek(loop.length() + 10));
+  TEST_ASSERT_EQUAL(XFADE * 2, loop.read(out, XFADE * 2));
+  TEST_ASSERT_EQUAL_MEMORY(hum + 10, out, XFADE * 2 * sizeof(int16_t));
+}
+
+void test_short_source() {
+  MemoryPcm pcm;
+  HumLoop loop;
+  pcm.begin(hum, 0);
+  TEST_ASSERT_FALSE(loop.begin(pcm, XFADE));
+  int16_t out[4];
+  TEST_ASSERT_EQUAL(0, loop.read(out, 4));
+
+  // the crossfade shrinks to a quarter of the sound
+  pcm.begin(hum, 400);
+  TEST_ASSERT_TRUE(loop.begin(pcm, XFADE));
+  TEST_ASSERT_EQUAL(300, loop.length());
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_hum_has_a_click_when_looped_plainly);
+  RUN_TEST(test_no_gap_or_click_at_the_loop_point);
+  RUN_TEST(test_loop_is_periodic);
+  RUN_TEST(test_seek_into_the_head);
+  RUN_TEST(test_short_source);
+  return UNITY_END();
+}
@@ -0,0 +1,102 @@
+//
+// Ignition curve tables against the float curves they were made from.
+//
+
+#include <math.h>
+#include <unity.h>
+
+#include "IgnitionCurve.h"
+
+
+void setUp() {}
+void tearDown() {}
+
+
+static double bounceRef(double t) {
+  if (t < 1 / 2.75)
+    return 7.5625 * t * t;
+  if (t < 2 / 2.75) {
+    t -= 1.5 / 2.75;
+    return 7.5625 * t * t + 0.75;
+  }
+  if (t < 2.5 / 2.75) {
+    t -= 2.25 / 2.75;
+    return 7.5625 * t * t + 0.9375;
+  }
+  t -= 2.625 / 2.75;
+  return 7.5625 * t * t + 0.984375;
+}
+
+// largest difference over the whole curve, in parts of the blade length
+static double maxError(IgnitionCurve curve, double (*ref)(double), double from = 0) {
+  double worst = 0;
+  for (uint32_t t = 0; t <= CURVE_ONE; t += 7) {
+    double x = (double)t / CURVE_ONE;
+    if (x < from)
+      continue;
+    double error = fabs(curveAt(curve, t) / (double)CURVE_ONE - ref(x));
+    if (error > worst)
+      worst = error;
+  }
+  return worst;
+}
+
+
+// sqrt is steep at the start, the first of the 64 segments is the worst:
+// 3% there is 1.5 pixels of a 50 pixel blade for 15 ms of the ignition
+void test_sqrt() {
+  TEST_ASSERT_FLOAT_WITHIN(0.035, 0, maxError(CURVE_SQRT, [](double t) { return sqrt(t); }));
+  TEST_ASSERT_FLOAT_WITHIN(0.002, 0, maxError(CURVE_SQRT, [](double t) { return sqrt(t); }, 1.0 / 16));
+}
+
+void test_ease_in_out() {
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0, maxError(CURVE_EASE_IN_OUT, [](double t) { return t * t * (3 - 2 * t); }));
+}
+
+// the segments cut the corners of the bounces
+void test_bounce() {
+  TEST_ASSERT_FLOAT_WITHIN(0.03, 0, maxError(CURVE_BOUNCE, bounceRef));
+}
+
+// flicker only ever drops below sqrt, and not at the ends
+void test_flicker_in() {
+  int dropouts = 0;
+  for (int i = 0; i <= CURVE_STEPS; i++) {
+    uint32_t t = i * CURVE_ONE / CURVE_STEPS;
+    uint16_t flicker = curveAt(CURVE_FLICKER_IN, t);
+    uint16_t plain = curveAt(CURVE_SQRT, t);
+    TEST_ASSERT_LESS_OR_EQUAL(plain + 1, flicker);
+    dropouts += flicker < plain * 0.7;
+  }
+  TEST_ASSERT_GREATER_THAN(0, dropouts);
+  TEST_ASSERT_EQUAL(CURVE_ONE, curveAt(CURVE_FLICKER_IN, CURVE_ONE));
+}
+
+void test_end_points() {
+  for (int c = 0; c < CURVE_COUNT; c++) {
+    TEST_ASSERT_EQUAL(0, curveAt((IgnitionCurve)c, 0));
+    TEST_ASSERT_EQUAL(CURVE_ONE, curveAt((IgnitionCurve)c, CURVE_ONE));
+    TEST_ASSERT_EQUAL(CURVE_ONE, curveAt((IgnitionCurve)c, CURVE_ONE + 1000));
+  }
+  // unknown curves fall back to sqrt
+  TEST_ASSERT_EQUAL(curveAt(CURVE_SQRT, 20000), curveAt(CURVE_COUNT, 20000));
+}
+
+// the tables are built by the compiler
+void test_tables_are_constexpr() {
+  constexpr uint16_t half = curve::tables[CURVE_EASE_IN_OUT].v[CURVE_STEPS / 2];
+  static_assert(half == 32768, "smoothstep(0.5) is 0.5");
+  TEST_ASSERT_EQUAL(32768, half);
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sqrt);
+  RUN_TEST(test_ease_in_out);
+  RUN_TEST(test_bounce);
+  RUN_TEST(test_flicker_in);
+  RUN_TEST(test_end_points);
+  RUN_TEST(test_tables_are_constexpr);
+  return UNITY_END();
+}
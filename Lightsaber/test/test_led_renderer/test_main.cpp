@@ -0,0 +1,221 @@
+//
+// LedRenderer against a fake strip: dirty tracking, the frame rate cap,
+// the counters and the current limit.
+//
+
+#include <string.h>
+#include <unity.h>
+
+#include "LedRenderer.h"
+
+#define PIXELS 50
+#define FPS    100
+#define FRAME  (1000000 / FPS)     // us
+
+class FakeStrip : public StripDriver {
+  public:
+    void show(const uint32_t *frame, uint16_t count) override {
+      memcpy(last, frame, count * sizeof(uint32_t));
+      this->count = count;
+      shows++;
+    }
+
+    uint32_t last[LED_MAX_PIXELS];
+    uint16_t count = 0;
+    uint32_t shows = 0;
+};
+
+// WS2812 estimate of what the strip was sent, as PowerLimiter counts it
+static uint32_t sentMa(const FakeStrip &strip, uint8_t copies = 1) {
+  uint32_t sum = 0;
+  for (uint16_t i = 0; i < strip.count; i++)
+    sum += (strip.last[i] & 0xff) + (strip.last[i] >> 8 & 0xff) + (strip.last[i] >> 16);
+  return ((uint32_t)strip.count * POWER_IDLE_MA + sum * POWER_CHANNEL_MA / 255) * copies;
+}
+
+
+void setUp() {}
+void tearDown() {}
+
+
+void test_only_changed_frames_are_sent() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, FPS);
+
+  TEST_ASSERT_TRUE(leds.render(0));          // the first frame goes out in any case
+  TEST_ASSERT_EQUAL(PIXELS, strip.count);
+  TEST_ASSERT_FALSE(leds.render(FRAME));
+  TEST_ASSERT_FALSE(leds.render(2 * FRAME));
+
+  leds.set(3, 0xff0000);
+  TEST_ASSERT_TRUE(leds.dirty());
+  TEST_ASSERT_TRUE(leds.render(3 * FRAME));
+  TEST_ASSERT_EQUAL_HEX32(0xff0000, strip.last[3]);
+
+  // writing the same color again is no change
+  leds.set(3, 0xff0000);
+  leds.fill(0, 4, 10);
+  TEST_ASSERT_FALSE(leds.dirty());
+  TEST_ASSERT_FALSE(leds.render(4 * FRAME));
+
+  TEST_ASSERT_EQUAL(2, strip.shows);
+  TEST_ASSERT_EQUAL(2, leds.framesRendered());
+  // nothing changed in between, an idle render() is no skipped frame
+  TEST_ASSERT_EQUAL(0, leds.framesSkipped());
+}
+
+// changes faster than the frame rate wait for the interval, the latest
+// state is what goes out
+void test_frame_rate_cap() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, FPS);
+  leds.render(0);
+
+  for (uint32_t t = 1000; t < 50000; t += 1000) {
+    leds.set(0, t);
+    leds.render(t);
+  }
+  ColorLut gamma;
+  TEST_ASSERT_EQUAL(5, strip.shows);
+  TEST_ASSERT_EQUAL_HEX32(gamma.map(40000), strip.last[0]);
+  TEST_ASSERT_TRUE(leds.dirty());
+  // 49 frames: 4 sent after the first, the last one still pending, the
+  // rest replaced while held back
+  TEST_ASSERT_EQUAL(4 + 1, leds.framesRendered());
+  TEST_ASSERT_EQUAL(44, leds.framesSkipped());
+  TEST_ASSERT_TRUE(leds.render(50000));
+  TEST_ASSERT_EQUAL_HEX32(gamma.map(49000), strip.last[0]);
+}
+
+// due() is the render() frame interval, dirty or not
+void test_due() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, FPS);
+  TEST_ASSERT_TRUE(leds.due(0));              // nothing sent yet
+  leds.render(1000);
+  TEST_ASSERT_FALSE(leds.due(1000));
+  TEST_ASSERT_FALSE(leds.due(1000 + FRAME - 1));
+  TEST_ASSERT_TRUE(leds.due(1000 + FRAME));
+
+  // a frame composed only when due is never held back or replaced
+  for (uint32_t t = 2000; t < 100000; t += 1000) {
+    if (leds.due(t)) {
+      leds.set(0, t);
+      TEST_ASSERT_TRUE(leds.render(t));
+    }
+  }
+  TEST_ASSERT_EQUAL(10, leds.framesRendered());
+  TEST_ASSERT_EQUAL(0, leds.framesSkipped());
+}
+
+void test_no_cap() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, 0);
+  for (uint32_t t = 0; t < 10; t++) {
+    leds.set(0, t + 1);
+    TEST_ASSERT_TRUE(leds.render(t));
+  }
+}
+
+// micros() wraps after 71 minutes
+void test_clock_wrap() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, FPS);
+  leds.render(UINT32_MAX - FRAME / 2);
+  leds.set(0, 1);
+  TEST_ASSERT_FALSE(leds.render(FRAME / 4));
+  TEST_ASSERT_TRUE(leds.render(FRAME / 2));
+}
+
+void test_brightness_goes_through_the_lut() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, 0);
+  leds.fill(0xffffff);
+  leds.render(0);
+  TEST_ASSERT_EQUAL_HEX32(0xffffff, strip.last[0]);
+  // the frame buffer keeps the linear color
+  TEST_ASSERT_EQUAL_HEX32(0xffffff, leds.get(0));
+
+  leds.setBrightness(127);
+  TEST_ASSERT_TRUE(leds.dirty());
+  leds.render(1);
+  TEST_ASSERT_EQUAL_HEX32(0x808080, strip.last[0]);
+  leds.setBrightness(127);
+  TEST_ASSERT_FALSE(leds.dirty());
+}
+
+void test_length() {
+  FakeStrip strip;
+  LedRenderer leds(strip, LED_MAX_PIXELS + 10, 0);
+  TEST_ASSERT_EQUAL(LED_MAX_PIXELS, leds.numPixels());
+
+  leds.setNumPixels(20);
+  leds.set(30, 0xffffff);
+  TEST_ASSERT_EQUAL_HEX32(0, leds.get(30));
+  leds.render(0);
+  TEST_ASSERT_EQUAL(20, strip.count);
+}
+
+// full white on 50 px is ~3 A unlimited, already the first frame stays
+// under the budget
+void test_full_white_under_budget() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, 0);
+  leds.setBrightness(255);
+  leds.fill(0xffffff);
+  TEST_ASSERT_TRUE(leds.render(0));
+  TEST_ASSERT_EQUAL(PIXELS * POWER_IDLE_MA + PIXELS * 3 * POWER_CHANNEL_MA, sentMa(strip));
+
+  leds.setPowerBudget(2000);
+  TEST_ASSERT_TRUE(leds.render(1));
+  TEST_ASSERT_LESS_OR_EQUAL(2000, sentMa(strip));
+  TEST_ASSERT_GREATER_THAN(1900, sentMa(strip));
+  TEST_ASSERT_LESS_OR_EQUAL(2000, leds.limiter().currentMa());
+  TEST_ASSERT_FALSE(leds.dirty());
+
+  // mirrored on two strips, each draws the current
+  leds.setPowerBudget(2000, 2);
+  TEST_ASSERT_TRUE(leds.render(2));
+  TEST_ASSERT_LESS_OR_EQUAL(2000, sentMa(strip, 2));
+  TEST_ASSERT_GREATER_THAN(1900, sentMa(strip, 2));
+}
+
+// back under budget the scale creeps up, frames keep going out until it
+// is back at full scale, none of them over budget
+void test_limit_recovers() {
+  FakeStrip strip;
+  LedRenderer leds(strip, PIXELS, 0);
+  leds.setBrightness(255);
+  leds.setPowerBudget(2000);
+  leds.fill(0xffffff);
+  leds.render(0);
+  uint16_t scale = leds.limiter().scale();
+  TEST_ASSERT_LESS_THAN(POWER_SCALE_ONE, scale);
+
+  leds.fill(0x0000ff);
+  uint32_t frames = 0;
+  for (uint32_t t = 1; leds.render(t); t++) {
+    TEST_ASSERT_LESS_OR_EQUAL(2000, sentMa(strip));
+    TEST_ASSERT_TRUE(leds.limiter().scale() <= scale + POWER_RISE);
+    scale = leds.limiter().scale();
+    frames++;
+  }
+  TEST_ASSERT_EQUAL(POWER_SCALE_ONE, leds.limiter().scale());
+  TEST_ASSERT_EQUAL_HEX32(0x0000ff, strip.last[0]);
+  TEST_ASSERT_GREATER_THAN(1, frames);
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_only_changed_frames_are_sent);
+  RUN_TEST(test_frame_rate_cap);
+  RUN_TEST(test_due);
+  RUN_TEST(test_no_cap);
+  RUN_TEST(test_clock_wrap);
+  RUN_TEST(test_brightness_goes_through_the_lut);
+  RUN_TEST(test_length);
+  RUN_TEST(test_full_white_under_budget);
+  RUN_TEST(test_limit_recovers);
+  return UNITY_END();
+}
@@ -0,0 +1,150 @@
+//
+// MetricsRegistry: registration, the spare slot, low water marks, the
+// metrics line with rates, truncation, and counters hit from two threads.
+//
+
+#include <string.h>
+#include <thread>
+#include <unity.h>
+
+#include "Metrics.h"
+
+#define THREAD_INCS 1000000
+
+
+void setUp() {}
+void tearDown() {}
+
+
+void test_add_is_idempotent() {
+  MetricsRegistry registry;
+  int loops = registry.add("loops", METRIC_COUNTER);
+  int pcm = registry.add("pcm", METRIC_GAUGE);
+  TEST_ASSERT_EQUAL(0, loops);
+  TEST_ASSERT_EQUAL(1, pcm);
+  TEST_ASSERT_EQUAL(loops, registry.add("loops", METRIC_COUNTER));
+  TEST_ASSERT_EQUAL(2, registry.count());
+  TEST_ASSERT_EQUAL_STRING("pcm", registry.name(pcm));
+  TEST_ASSERT_EQUAL(METRIC_GAUGE, registry.kind(pcm));
+
+  // long names are cut, the cut name finds the same slot
+  int id = registry.add("a_very_long_metric_name", METRIC_GAUGE);
+  TEST_ASSERT_EQUAL(METRICS_NAME_LEN - 1, strlen(registry.name(id)));
+  TEST_ASSERT_EQUAL(id, registry.add("a_very_long_metric_name", METRIC_GAUGE));
+}
+
+// a full table hands out the spare id, which works but is never shown
+void test_full_table_uses_spare() {
+  MetricsRegistry registry;
+  char name[8];
+  for (int i = 0; i < METRICS_MAX; i++) {
+    snprintf(name, sizeof(name), "m%d", i);
+    TEST_ASSERT_EQUAL(i, registry.add(name, METRIC_COUNTER));
+  }
+  int spare = registry.add("late", METRIC_COUNTER);
+  TEST_ASSERT_EQUAL(METRICS_MAX, spare);
+  TEST_ASSERT_EQUAL(METRICS_MAX, registry.count());
+  registry.inc(spare, 5);
+
+  MetricsSnapshot snapshot;
+  char line[512];
+  registry.snapshot(snapshot, 0);
+  TEST_ASSERT_EQUAL(METRICS_MAX, snapshot.count);
+  registry.format(snapshot, nullptr, line, sizeof(line));
+  TEST_ASSERT_NULL(strstr(line, "late"));
+  TEST_ASSERT_NOT_NULL(strstr(line, " m23=0"));
+}
+
+void test_gauge_and_min() {
+  MetricsRegistry registry;
+  int pcm = registry.add("pcm", METRIC_GAUGE);
+  int low = registry.add("pcm_low", METRIC_MIN);
+  TEST_ASSERT_EQUAL(UINT32_MAX, registry.get(low));
+
+  MetricsSnapshot snapshot;
+  char line[128];
+  registry.snapshot(snapshot, 10);
+  registry.format(snapshot, nullptr, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("metrics t=10 pcm=0 pcm_low=-", line);
+
+  const uint32_t fills[] = { 768, 512, 900, 256, 600 };
+  for (uint32_t fill : fills) {
+    registry.set(pcm, fill);
+    registry.min(low, fill);
+  }
+  TEST_ASSERT_EQUAL(600, registry.get(pcm));
+  TEST_ASSERT_EQUAL(256, registry.get(low));
+}
+
+// counters get their rate against the previous snapshot, a counter added
+// in between has none yet
+void test_rates() {
+  MetricsRegistry registry;
+  int loops = registry.add("loops", METRIC_COUNTER);
+  MetricsSnapshot first, second;
+  char line[128];
+
+  registry.inc(loops, 1000);
+  registry.snapshot(first, 1000);
+  registry.format(first, nullptr, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("metrics t=1000 loops=1000", line);
+
+  int frames = registry.add("frames", METRIC_COUNTER);
+  registry.inc(loops, 50000);
+  registry.inc(frames, 40);
+  registry.snapshot(second, 1500);
+  size_t n = registry.format(second, &first, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("metrics t=1500 loops=51000 loops/s=100000 frames=40", line);
+  TEST_ASSERT_EQUAL(strlen(line), n);
+}
+
+// a short buffer gets as much of the line as fits, terminated
+void test_truncation() {
+  MetricsRegistry registry;
+  char name[8];
+  for (int i = 0; i < 10; i++) {
+    snprintf(name, sizeof(name), "m%d", i);
+    registry.inc(registry.add(name, METRIC_COUNTER), 123456);
+  }
+  MetricsSnapshot snapshot;
+  registry.snapshot(snapshot, 0);
+
+  char line[40];
+  memset(line, 'x', sizeof(line));
+  size_t n = registry.format(snapshot, nullptr, line, sizeof(line));
+  TEST_ASSERT_EQUAL(sizeof(line) - 1, n);
+  TEST_ASSERT_EQUAL(sizeof(line) - 1, strlen(line));
+  TEST_ASSERT_EQUAL(0, strncmp(line, "metrics t=0 m0=123456 m1=123456", 31));
+}
+
+// updates from two tasks are never lost
+void test_threaded_inc() {
+  static MetricsRegistry registry;
+  static int id, low;
+  id = registry.add("loops", METRIC_COUNTER);
+  low = registry.add("low", METRIC_MIN);
+
+  auto work = [](uint32_t offset) {
+    for (uint32_t i = 0; i < THREAD_INCS; i++) {
+      registry.inc(id);
+      registry.min(low, THREAD_INCS - i + offset);
+    }
+  };
+  std::thread a(work, 0), b(work, 7);
+  a.join();
+  b.join();
+  TEST_ASSERT_EQUAL(2 * THREAD_INCS, registry.get(id));
+  TEST_ASSERT_EQUAL(1, registry.get(low));
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_add_is_idempotent);
+  RUN_TEST(test_full_table_uses_spare);
+  RUN_TEST(test_gauge_and_min);
+  RUN_TEST(test_rates);
+  RUN_TEST(test_truncation);
+  RUN_TEST(test_threaded_inc);
+  return UNITY_END();
+}
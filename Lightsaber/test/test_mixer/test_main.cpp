@@ -0,0 +1,141 @@
+//
+// Mixer: gains, saturation and the end of one-shot and looped voices.
+//
+
+#include <unity.h>
+
+#include "Mixer.h"
+#include "MemoryPcm.h"
+
+static int16_t ramp[100];
+static int16_t full[MIXER_BLOCK];
+
+
+void setUp() {
+  for (int i = 0; i < 100; i++)
+    ramp[i] = (int16_t)(i * 100 - 5000);
+  for (int i = 0; i < MIXER_BLOCK; i++)
+    full[i] = i & 1 ? INT16_MIN : INT16_MAX;
+}
+
+void tearDown() {}
+
+
+void test_silence_without_voices() {
+  Mixer mixer;
+  int32_t out[64];
+  TEST_ASSERT_EQUAL(64, mixer.mix(out, 64));
+  for (int i = 0; i < 64; i++)
+    TEST_ASSERT_EQUAL_INT32(0, out[i]);
+  TEST_ASSERT_EQUAL(0, mixer.activeCount());
+}
+
+// unity gain puts the sample in the upper 16 bits of the I2S sample
+void test_unity_and_half_gain() {
+  Mixer mixer;
+  MemoryPcm a, b;
+  a.begin(ramp, 100);
+  b.begin(ramp, 100);
+  int32_t out[100];
+
+  mixer.play(0, a);
+  mixer.mix(out, 100);
+  for (int i = 0; i < 100; i++)
+    TEST_ASSERT_EQUAL_INT32(ramp[i] * 65536, out[i]);
+
+  mixer.play(0, a, MIXER_UNITY / 2);
+  mixer.play(1, b, MIXER_UNITY / 2);
+  mixer.mix(out, 100);
+  for (int i = 0; i < 100; i++)
+    TEST_ASSERT_EQUAL_INT32(ramp[i] * 65536, out[i]);
+}
+
+void test_saturation() {
+  Mixer mixer;
+  MemoryPcm pcm[MIXER_VOICES];
+  int32_t out[MIXER_BLOCK];
+
+  for (int v = 0; v < MIXER_VOICES; v++) {
+    pcm[v].begin(full, MIXER_BLOCK);
+    mixer.play(v, pcm[v]);
+  }
+  TEST_ASSERT_EQUAL(MIXER_VOICES, mixer.activeCount());
+  mixer.mix(out, MIXER_BLOCK);
+  TEST_ASSERT_EQUAL_INT32(INT16_MAX * 65536, out[0]);
+  TEST_ASSERT_EQUAL_INT32(INT16_MIN * 65536, out[1]);
+}
+
+// a one-shot voice pads the block with silence and stops
+void test_one_shot_ends() {
+  Mixer mixer;
+  MemoryPcm pcm;
+  pcm.begin(ramp, 100);
+  int32_t out[MIXER_BLOCK];
+
+  mixer.play(2, pcm);
+  TEST_ASSERT_TRUE(mixer.active(2));
+  mixer.mix(out, 150);
+  TEST_ASSERT_EQUAL_INT32(ramp[99] * 65536, out[99]);
+  TEST_ASSERT_EQUAL_INT32(0, out[100]);
+  TEST_ASSERT_FALSE(mixer.active(2));
+}
+
+// a looped voice wraps inside the block and keeps playing
+void test_loop_wraps() {
+  Mixer mixer;
+  MemoryPcm pcm;
+  pcm.begin(ramp, 100);
+  int32_t out[MIXER_BLOCK];
+
+  mixer.play(0, pcm, MIXER_UNITY, true);
+  for (int block = 0; block < 4; block++) {
+    mixer.mix(out, MIXER_BLOCK);
+    for (int i = 0; i < MIXER_BLOCK; i++)
+      TEST_ASSERT_EQUAL_INT32(ramp[(block * MIXER_BLOCK + i) % 100] * 65536, out[i]);
+  }
+  TEST_ASSERT_TRUE(mixer.active(0));
+
+  // an empty looped source does not spin
+  MemoryPcm empty;
+  empty.begin(ramp, 0);
+  mixer.play(1, empty, MIXER_UNITY, true);
+  mixer.mix(out, MIXER_BLOCK);
+  TEST_ASSERT_FALSE(mixer.active(1));
+}
+
+void test_play_restarts_and_stop() {
+  Mixer mixer;
+  MemoryPcm pcm;
+  pcm.begin(ramp, 100);
+  int32_t out[10];
+
+  mixer.play(0, pcm);
+  mixer.mix(out, 10);
+  mixer.play(0, pcm);
+  mixer.mix(out, 10);
+  TEST_ASSERT_EQUAL_INT32(ramp[0] * 65536, out[0]);
+
+  mixer.stop(0);
+  mixer.mix(out, 10);
+  TEST_ASSERT_EQUAL_INT32(0, out[0]);
+  TEST_ASSERT_FALSE(mixer.play(MIXER_VOICES, pcm));
+}
+
+void test_block_limit() {
+  Mixer mixer;
+  int32_t out[MIXER_BLOCK];
+  TEST_ASSERT_EQUAL(MIXER_BLOCK, mixer.mix(out, MIXER_BLOCK + 100));
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_silence_without_voices);
+  RUN_TEST(test_unity_and_half_gain);
+  RUN_TEST(test_saturation);
+  RUN_TEST(test_one_shot_ends);
+  RUN_TEST(test_loop_wraps);
+  RUN_TEST(test_play_restarts_and_stop);
+  RUN_TEST(test_block_limit);
+  return UNITY_END();
+}
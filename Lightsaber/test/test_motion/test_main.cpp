@@ -0,0 +1,176 @@
+//
+// Swing and clash detection on recorded style traces replayed through a
+// TraceSensor at the motion task rate.
+//
+
+#include <vector>
+#include <unity.h>
+
+#include "MotionDetector.h"
+#include "TraceSensor.h"
+
+#define PERIOD 2                    // ms between samples, 500 Hz
+#define DPS(x) ((int16_t)((x) * 16.4))
+
+static std::vector<MotionSample> trace;
+static std::vector<MotionEvent> events;
+
+static MotionSample rest() {
+  return { 0, 0, MOTION_ACCEL_1G, 0, 0, 0 };
+}
+
+static void add(uint32_t ms, MotionSample s) {
+  for (uint32_t t = 0; t < ms; t += PERIOD)
+    trace.push_back(s);
+}
+
+// rotation rising to peak deg/s and back over ms
+static void swing(uint32_t ms, int peak) {
+  uint32_t steps = ms / PERIOD;
+  for (uint32_t i = 0; i < steps; i++) {
+    MotionSample s = rest();
+    s.gy = DPS(peak * (i < steps / 2 ? i : steps - i) * 2 / (int)steps);
+    trace.push_back(s);
+  }
+}
+
+static void replay() {
+  TraceSensor sensor(trace.data(), trace.size());
+  MotionDetector detector;
+  MotionSample sample;
+  MotionEvent event;
+  TEST_ASSERT_TRUE(sensor.begin());
+  for (uint32_t t = 0; sensor.read(sample); t += PERIOD) {
+    if (detector.update(sample, t, event))
+      events.push_back(event);
+  }
+}
+
+static int count(uint8_t type) {
+  int n = 0;
+  for (const MotionEvent &e : events)
+    n += e.type == type;
+  return n;
+}
+
+
+void setUp() {
+  trace.clear();
+  events.clear();
+}
+
+void tearDown() {}
+
+
+void test_rest_is_quiet() {
+  MotionSample tilted = { 2896, 0, 2896, 0, 0, 0 };   // 45 degrees
+  add(5000, rest());
+  add(5000, tilted);
+  replay();
+  TEST_ASSERT_EQUAL(0, events.size());
+}
+
+// sensor noise of a hand held blade, +-0.1 g and +-40 deg/s
+void test_noise_is_quiet() {
+  uint32_t random = 1;
+  for (int i = 0; i < 5000; i++) {
+    MotionSample s = rest();
+    random = random * 1664525 + 1013904223;
+    s.ax = (int16_t)((int32_t)(random >> 16 & 0x3ff) - 512) * 8 / 10;
+    s.gx = DPS((int32_t)(random >> 8 & 0x7f) - 64) * 5 / 8;
+    trace.push_back(s);
+  }
+  replay();
+  TEST_ASSERT_EQUAL(0, events.size());
+}
+
+// one event per swing, the next swing is armed once the speed drops
+void test_swings() {
+  add(500, rest());
+  swing(300, 600);
+  add(500, rest());
+  swing(300, 600);
+  add(500, rest());
+  swing(300, 150);     // too slow
+  add(500, rest());
+  replay();
+
+  TEST_ASSERT_EQUAL(2, count(MOTION_SWING));
+  TEST_ASSERT_EQUAL(0, count(MOTION_CLASH));
+  // reported on the way up, before the peak at 650 ms
+  TEST_ASSERT_GREATER_THAN(500, events[0].time);
+  TEST_ASSERT_LESS_THAN(650, events[0].time);
+  TEST_ASSERT_GREATER_OR_EQUAL(250, events[0].strength);
+}
+
+// a long swing held above the release speed is one swing
+void test_held_swing() {
+  MotionSample fast = rest();
+  fast.gz = DPS(400);
+  add(200, rest());
+  add(2000, fast);
+  add(500, rest());
+  replay();
+  TEST_ASSERT_EQUAL(1, count(MOTION_SWING));
+}
+
+void test_clash_and_holdoff() {
+  MotionSample hit = rest();
+  hit.ax = 4 * MOTION_ACCEL_1G;
+  add(500, rest());
+  add(4, hit);
+  add(100, rest());
+  add(4, hit);          // within the holdoff
+  add(500, rest());
+  add(4, hit);
+  add(200, rest());
+  replay();
+
+  TEST_ASSERT_EQUAL(2, count(MOTION_CLASH));
+  TEST_ASSERT_EQUAL(500, events[0].time);
+  TEST_ASSERT_GREATER_OR_EQUAL(2500, events[0].strength);
+  TEST_ASSERT_EQUAL(1108, events[1].time);
+}
+
+void test_swing_speed_is_readable() {
+  MotionSample fast = rest();
+  fast.gz = DPS(400);
+  add(500, fast);
+  TraceSensor sensor(trace.data(), trace.size());
+  MotionDetector detector;
+  MotionSample sample;
+  MotionEvent event;
+  sensor.begin();
+  for (uint32_t t = 0; sensor.read(sample); t += PERIOD)
+    detector.update(sample, t, event);
+  TEST_ASSERT_INT_WITHIN(5, 400, detector.swingSpeed());
+}
+
+void test_trace_sensor_loops() {
+  add(10, rest());
+  TraceSensor once(trace.data(), trace.size());
+  TraceSensor looped(trace.data(), trace.size(), true);
+  MotionSample sample;
+  once.begin();
+  looped.begin();
+  for (int i = 0; i < 5; i++) {
+    TEST_ASSERT_TRUE(once.read(sample));
+    TEST_ASSERT_TRUE(looped.read(sample));
+  }
+  TEST_ASSERT_FALSE(once.read(sample));
+  TEST_ASSERT_TRUE(looped.read(sample));
+  TEST_ASSERT_EQUAL(1, looped.position());
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_rest_is_quiet);
+  RUN_TEST(test_noise_is_quiet);
+  RUN_TEST(test_swings);
+  RUN_TEST(test_held_swing);
+  RUN_TEST(test_clash_and_holdoff);
+  RUN_TEST(test_swing_speed_is_readable);
+  RUN_TEST(test_trace_sensor_loops);
+  return UNITY_END();
+}
@@ -0,0 +1,179 @@
+//
+// ProfileTable: selection and wrap around, and switching profiles on a
+// running saber (lib/Sim) without a single allocation.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <string>
+#include <unity.h>
+
+#include "ProfileTable.h"
+#include "Simulation.h"
+
+// every operator new in the process is counted
+static volatile uint32_t allocations;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static std::string dataDir;
+
+
+static Profile profile(const char *name, uint32_t color) {
+  Profile p = {};
+  snprintf(p.name, sizeof(p.name), "%s", name);
+  p.color = color;
+  p.brightness = 255;
+  return p;
+}
+
+
+static void writeConfig(const SaberConfig &cfg) {
+  FILE *f = fopen((dataDir + "/config.bin").c_str(), "wb");
+  TEST_ASSERT_NOT_NULL(f);
+  fwrite(&cfg, sizeof(cfg), 1, f);
+  fclose(f);
+}
+
+
+void setUp() {
+  char dir[] = "/tmp/saberXXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+  dataDir = dir;
+  SaberConfig cfg;
+  configDefaults(cfg);
+  writeConfig(cfg);
+}
+
+void tearDown() {
+  std::string cmd = "rm -rf " + dataDir;
+  system(cmd.c_str());
+}
+
+
+void test_add_and_select() {
+  ProfileTable table;
+  TEST_ASSERT_EQUAL(0, table.count());
+  for (int i = 0; i < PROFILE_MAX; i++)
+    TEST_ASSERT_TRUE(table.add(profile("p", i)));
+  TEST_ASSERT_FALSE(table.add(profile("full", 0)));
+  TEST_ASSERT_EQUAL(PROFILE_MAX, table.count());
+
+  TEST_ASSERT_TRUE(table.select(3));
+  TEST_ASSERT_EQUAL(3, table.current().color);
+  TEST_ASSERT_FALSE(table.select(PROFILE_MAX));
+  TEST_ASSERT_EQUAL(3, table.index());
+}
+
+void test_next_previous_wrap() {
+  ProfileTable table;
+  table.add(profile("red", 0xff0000));
+  table.add(profile("green", 0x00ff00));
+  table.add(profile("blue", 0x0000ff));
+
+  TEST_ASSERT_EQUAL(2, table.previous());
+  TEST_ASSERT_EQUAL_STRING("blue", table.current().name);
+  TEST_ASSERT_EQUAL(0, table.next());
+  TEST_ASSERT_EQUAL(1, table.next());
+  TEST_ASSERT_EQUAL(0x00ff00, table.current().color);
+}
+
+void test_empty_table() {
+  ProfileTable table;
+  TEST_ASSERT_EQUAL(0, table.next());
+  TEST_ASSERT_EQUAL(0, table.previous());
+  TEST_ASSERT_EQUAL(0, table.index());
+  TEST_ASSERT_FALSE(table.select(0));
+}
+
+void test_cycle_without_allocation() {
+  static ProfileTable table;
+  for (int i = 0; i < PROFILE_MAX; i++)
+    table.add(profile("p", i));
+
+  uint32_t before = allocations;
+  for (int i = 0; i < 1000; i++) {
+    table.next();
+    if (i % 3 == 0)
+      table.previous();
+    TEST_ASSERT_EQUAL(table.index(), table.current().color);
+  }
+  TEST_ASSERT_EQUAL(before, allocations);
+}
+
+// the config's soundProfile only picks the hum set, the blade keeps the
+// configured look
+void test_sound_profile_keeps_config_look() {
+  SaberConfig cfg;
+  configDefaults(cfg);
+  cfg.color = 0xff2000;
+  cfg.brightness = 77;
+  cfg.soundProfile = 1;
+  configSeal(cfg);
+  writeConfig(cfg);
+
+  Simulation sim(dataDir.c_str(), nullptr, true);
+  TEST_ASSERT_TRUE(sim.begin());
+  const ProfileTable &profiles = sim.saber().profiles();
+  TEST_ASSERT_EQUAL(0, profiles.index());
+  TEST_ASSERT_EQUAL_HEX32(0xff2000, profiles.current().color);
+  TEST_ASSERT_EQUAL(77, profiles.current().brightness);
+  TEST_ASSERT_EQUAL(1, profiles.current().humSet);
+  TEST_ASSERT_EQUAL(77, sim.saber().leds().brightness());
+}
+
+// double clicks on a lit blade: no allocation from the first edge to the
+// frame in the new color, which is sent within one frame period
+void test_switch_on_saber() {
+  Simulation sim(dataDir.c_str(), nullptr, true);
+  TEST_ASSERT_TRUE(sim.begin());
+  sim.button.press(500, 80);
+  sim.run(2500);
+  TEST_ASSERT_TRUE(sim.saber().blade().isOn());
+
+  for (int i = 0; i < 2 * PROFILE_MAX; i++) {
+    uint32_t t = sim.clock.millis() + 100;
+    uint8_t next = (sim.saber().profiles().index() + 1) % sim.saber().profiles().count();
+    sim.button.press(t, 60);
+    sim.button.press(t + 150, 60);
+    sim.run(t - 1 - sim.clock.millis());
+
+    uint32_t before = allocations;
+    uint32_t frames = sim.strips[0].frames();
+    while (sim.saber().profiles().index() != next) {
+      sim.step();
+      TEST_ASSERT_LESS_THAN(t + 1000, sim.clock.millis());
+    }
+    uint32_t switched = sim.clock.millis();
+    while (sim.strips[0].frames() == frames)
+      sim.step();
+    TEST_ASSERT_LESS_OR_EQUAL(switched + 1000 / SABER_MAX_FPS, sim.clock.millis());
+    TEST_ASSERT_EQUAL(before, allocations);
+    TEST_ASSERT_NOT_EQUAL(0, sim.strips[0].frame()[0]);
+  }
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_add_and_select);
+  RUN_TEST(test_next_previous_wrap);
+  RUN_TEST(test_empty_table);
+  RUN_TEST(test_cycle_without_allocation);
+  RUN_TEST(test_sound_profile_keeps_config_look);
+  RUN_TEST(test_switch_on_saber);
+  return UNITY_END();
+}
@@ -0,0 +1,155 @@
+//
+// ReadAhead: block bookkeeping, stalls and the end of the source single
+// threaded, then a filler and a decoder thread on a source that ends in a
+// partial block.
+//
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <unity.h>
+
+#include "ReadAhead.h"
+
+// the other side needs the CPU, the test host may have a single core
+static void waitABit() {
+  std::this_thread::sleep_for(std::chrono::microseconds(20));
+}
+
+// bytes i & 0xff ... from memory, counting reads
+class MemorySource : public ByteSource {
+  public:
+    MemorySource(size_t size) : data(size) {
+      for (size_t i = 0; i < size; i++)
+        data[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    size_t read(uint8_t *out, size_t len) override {
+      size_t n = len < data.size() - pos ? len : data.size() - pos;
+      memcpy(out, data.data() + pos, n);
+      pos += n;
+      reads++;
+      return n;
+    }
+    bool seek(uint32_t p) override { pos = p; return p <= data.size(); }
+    uint32_t size() override { return data.size(); }
+
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+    int reads = 0;
+};
+
+static ReadAhead ahead;
+
+
+void setUp() {}
+void tearDown() {}
+
+
+void test_fill_to_watermark() {
+  MemorySource source(10 * READAHEAD_BLOCK);
+  ahead.begin(source, 2);
+  TEST_ASSERT_EQUAL(2, ahead.fill());
+  TEST_ASSERT_EQUAL(0, ahead.fill());
+  TEST_ASSERT_EQUAL(2, source.reads);
+  TEST_ASSERT_EQUAL(2 * READAHEAD_BLOCK, ahead.buffered());
+
+  uint8_t out[READAHEAD_BLOCK];
+  TEST_ASSERT_EQUAL(READAHEAD_BLOCK, ahead.read(out, READAHEAD_BLOCK));
+  TEST_ASSERT_EQUAL_MEMORY(source.data.data(), out, READAHEAD_BLOCK);
+  TEST_ASSERT_EQUAL(1, ahead.fill());
+  TEST_ASSERT_EQUAL(0, ahead.stalls());
+}
+
+// reads in odd sizes across block boundaries, then the end of the source
+void test_whole_source() {
+  const size_t size = 3 * READAHEAD_BLOCK + 123;
+  MemorySource source(size);
+  std::vector<uint8_t> out(size + 100);
+  ahead.begin(source);
+
+  size_t done = 0;
+  while (!ahead.eof()) {
+    ahead.fill();
+    TEST_ASSERT_EQUAL(source.data[done], ahead.peek());
+    done += ahead.read(out.data() + done, 1000);
+  }
+  TEST_ASSERT_EQUAL(size, done);
+  TEST_ASSERT_EQUAL_MEMORY(source.data.data(), out.data(), size);
+  TEST_ASSERT_EQUAL(-1, ahead.peek());
+  TEST_ASSERT_EQUAL(0, ahead.read(out.data(), 10));
+  TEST_ASSERT_EQUAL(0, ahead.stalls());
+}
+
+// a source of whole blocks ends in an empty one
+void test_exact_blocks() {
+  MemorySource source(2 * READAHEAD_BLOCK);
+  uint8_t out[READAHEAD_BLOCK];
+  ahead.begin(source);
+  TEST_ASSERT_EQUAL(3, ahead.fill());
+  TEST_ASSERT_FALSE(ahead.eof());
+  TEST_ASSERT_EQUAL(READAHEAD_BLOCK, ahead.read(out, READAHEAD_BLOCK));
+  TEST_ASSERT_EQUAL(READAHEAD_BLOCK, ahead.read(out, READAHEAD_BLOCK));
+  TEST_ASSERT_EQUAL(0, ahead.read(out, READAHEAD_BLOCK));
+  TEST_ASSERT_TRUE(ahead.eof());
+  TEST_ASSERT_EQUAL(0, ahead.stalls());
+}
+
+// nothing buffered before the end is a stall, the end itself is not
+void test_stalls() {
+  MemorySource source(READAHEAD_BLOCK + 10);
+  uint8_t out[100];
+  ahead.begin(source);
+  TEST_ASSERT_EQUAL(0, ahead.read(out, 100));
+  TEST_ASSERT_EQUAL(0, ahead.buffered());
+  TEST_ASSERT_EQUAL(1, ahead.stalls());
+
+  ahead.fill();
+  while (ahead.read(out, 100) > 0)
+    ;
+  TEST_ASSERT_TRUE(ahead.eof());
+  TEST_ASSERT_EQUAL(1, ahead.stalls());
+}
+
+// the filler queues the last block before it flags the end: a decoder
+// racing it must never see eof() before it has read every byte
+void test_threaded_end_of_source() {
+  const size_t size = 5 * READAHEAD_BLOCK + 777;
+  MemorySource source(size);
+  std::vector<uint8_t> out(size);
+
+  for (int round = 0; round < 200; round++) {
+    static std::atomic<bool> stop;
+    source.pos = 0;
+    stop = false;
+    ahead.begin(source, 2);
+    std::thread filler([] {
+      while (!stop)
+        if (ahead.fill() == 0)
+          waitABit();
+    });
+    size_t done = 0;
+    while (!ahead.eof()) {
+      size_t n = ahead.read(out.data() + done, 500);
+      done += n;
+      if (n == 0)
+        waitABit();
+    }
+    stop = true;
+    filler.join();
+    TEST_ASSERT_EQUAL(size, done);
+    TEST_ASSERT_EQUAL_MEMORY(source.data.data(), out.data(), size);
+  }
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fill_to_watermark);
+  RUN_TEST(test_whole_source);
+  RUN_TEST(test_exact_blocks);
+  RUN_TEST(test_stalls);
+  RUN_TEST(test_threaded_end_of_source);
+  return UNITY_END();
+}
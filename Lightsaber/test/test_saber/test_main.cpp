@@ -0,0 +1,206 @@
+//
+// The whole firmware loop in a Simulation (lib/Sim): input handling while
+// the blade moves, a lockup held past the hold time and the audio ring.
+//
+// Every test boots a fresh saber from a data directory written here, so
+// the results do not depend on what is in data/.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <unity.h>
+
+#include "Simulation.h"
+#include "SoundBank.h"
+#include "Metrics.h"
+
+static std::string dataDir;
+
+
+static void writeFile(const std::string &name, const void *data, size_t size) {
+  FILE *f = fopen((dataDir + "/" + name).c_str(), "wb");
+  TEST_ASSERT_NOT_NULL(f);
+  fwrite(data, 1, size, f);
+  fclose(f);
+}
+
+// the default config as binary blob
+static void writeConfig() {
+  SaberConfig cfg;
+  configDefaults(cfg);
+  writeFile("config.bin", &cfg, sizeof(cfg));
+}
+
+// ms of virtual time until pred() holds, at most limit steps
+template<typename Pred>
+static uint32_t stepUntil(Simulation &sim, uint32_t limit, Pred pred) {
+  for (uint32_t i = 0; i < limit; i++) {
+    sim.step();
+    if (pred())
+      break;
+  }
+  return sim.clock.millis();
+}
+
+
+void setUp() {
+  char dir[] = "/tmp/saberXXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+  dataDir = dir;
+  writeConfig();
+}
+
+void tearDown() {
+  std::string cmd = "rm -rf " + dataDir;
+  system(cmd.c_str());
+}
+
+
+// a click ignites once the double click window is over, a double click
+// during the ignition switches the profile at its release
+void test_input_during_ignition() {
+  Simulation sim(dataDir.c_str(), nullptr, true);
+  TEST_ASSERT_TRUE(sim.begin());
+  sim.button.press(500, 80);
+  sim.button.press(900, 80);
+  sim.button.press(1100, 80);
+
+  uint32_t on = stepUntil(sim, 2000, [&]() { return !sim.saber().blade().isOff(); });
+  TEST_ASSERT_EQUAL(580 + 250 + 1, on);
+
+  uint32_t switched = stepUntil(sim, 2000, [&]() { return sim.saber().profiles().index() == 1; });
+  TEST_ASSERT_EQUAL(1180, switched);
+  TEST_ASSERT_EQUAL(BLADE_IGNITING, sim.saber().blade().state());
+
+  uint32_t frames = sim.strips[0].frames();
+  uint32_t shown = stepUntil(sim, 100, [&]() { return sim.strips[0].frames() != frames; });
+  TEST_ASSERT_LESS_OR_EQUAL(switched + 1000 / SABER_MAX_FPS, shown);
+
+  stepUntil(sim, 2000, [&]() { return sim.saber().blade().isOn(); });
+  TEST_ASSERT_EQUAL(on + 980, sim.clock.millis());
+}
+
+// every step of the ignition reaches the strip within one frame period
+void test_ignition_frames() {
+  Simulation sim(dataDir.c_str(), nullptr, true);
+  TEST_ASSERT_TRUE(sim.begin());
+  sim.button.press(500, 80);
+  stepUntil(sim, 2000, [&]() { return !sim.saber().blade().isOff(); });
+
+  // lit as last sent to the strip, time it first differed from the blade
+  uint16_t shown = 0;
+  uint32_t changed = 0;
+  uint32_t frames = sim.strips[0].frames();
+  while (!sim.saber().blade().isOn()) {
+    sim.step();
+    if (sim.strips[0].frames() != frames) {
+      frames = sim.strips[0].frames();
+      shown = sim.saber().blade().lit();
+    }
+    if (sim.saber().blade().lit() == shown)
+      changed = 0;
+    else if (changed == 0)
+      changed = sim.clock.millis();
+    TEST_ASSERT_TRUE(changed == 0 || sim.clock.millis() - changed < 1000 / SABER_MAX_FPS);
+  }
+}
+
+// the ignition of a long blade changes it more often than the frame cap,
+// it is composed only when the renderer takes a frame, so no composed frame
+// is thrown away
+void test_frames_composed_when_due() {
+  SaberConfig cfg;
+  configDefaults(cfg);
+  cfg.numPixels = LED_MAX_PIXELS;
+  configSeal(cfg);
+  writeFile("config.bin", &cfg, sizeof(cfg));
+
+  Simulation sim(dataDir.c_str(), nullptr, true);
+  TEST_ASSERT_TRUE(sim.begin());
+  sim.button.press(500, 80);
+  stepUntil(sim, 2000, [&]() { return !sim.saber().blade().isOff(); });
+
+  uint32_t frames = sim.saber().leds().framesRendered();
+  uint32_t start = sim.clock.millis();
+  stepUntil(sim, 2000, [&]() { return sim.saber().blade().isOn(); });
+  uint32_t sent = sim.saber().leds().framesRendered() - frames;
+  uint32_t ms = sim.clock.millis() - start;
+  TEST_ASSERT_LESS_OR_EQUAL(ms * SABER_MAX_FPS / 1000 + 1, sent);
+  TEST_ASSERT_GREATER_THAN(ms * SABER_MAX_FPS / 2000, sent);
+  TEST_ASSERT_EQUAL(0, sim.saber().leds().framesSkipped());
+}
+
+// a sound bank of short tones under the names the saber looks for
+static void writeSoundBank() {
+  static const char *names[] = { "on", "off", "swing", "hit", "Hum-4", "idle" };
+  const uint32_t length = SABER_SAMPLE_RATE / 2;
+  const int count = sizeof(names) / sizeof(names[0]);
+  std::vector<uint8_t> image(SOUNDBANK_DATA_START + count * length * 2);
+
+  SoundBankHeader *header = (SoundBankHeader *)image.data();
+  SoundBankEntry *entries = (SoundBankEntry *)(header + 1);
+  *header = { SOUNDBANK_MAGIC, SOUNDBANK_VERSION, (uint16_t)count, SABER_SAMPLE_RATE, (uint32_t)image.size() };
+  for (int i = 0; i < count; i++) {
+    snprintf(entries[i].name, SOUNDBANK_NAME_LEN, "%s", names[i]);
+    entries[i].offset = SOUNDBANK_DATA_START + i * length * 2;
+    entries[i].length = length;
+    int16_t *pcm = (int16_t *)(image.data() + entries[i].offset);
+    for (uint32_t n = 0; n < length; n++)
+      pcm[n] = (int16_t)(8000 * sin(2 * M_PI * n * (110 * (i + 1)) / SABER_SAMPLE_RATE));
+  }
+  writeFile("soundbank.bin", image.data(), image.size());
+}
+
+// no underrun from boot through ignition, hum, swings and the clash, the
+// ring never drained (pcm_low counts from the first I2S block)
+void test_audio_never_underruns() {
+  writeSoundBank();
+  Simulation sim(dataDir.c_str(), nullptr, true);
+  TEST_ASSERT_TRUE(sim.begin());
+  sim.button.press(500, 80);
+  sim.run(6000);
+
+  TEST_ASSERT_TRUE(sim.saber().blade().isOn());
+  TEST_ASSERT_EQUAL(0, sim.saber().audioUnderruns());
+  uint32_t low = metrics.get(metrics.add("pcm_low", METRIC_MIN));
+  TEST_ASSERT_GREATER_THAN(0, low);
+  TEST_ASSERT_LESS_THAN(UINT32_MAX, low);
+}
+
+// the simulated swing has a clash at 4.5 s: pressed through it, the lockup
+// runs until the release and the hold time passing does not retract
+void test_lockup_outlasts_hold() {
+  Simulation sim(dataDir.c_str(), nullptr, true);
+  TEST_ASSERT_TRUE(sim.begin());
+  sim.button.press(500, 80);
+  sim.button.press(4300, 1500);
+
+  uint32_t lockup = stepUntil(sim, 6000, [&]() { return sim.saber().effects().active(EFFECT_LOCKUP); });
+  TEST_ASSERT_INT_WITHIN(10, 4500, lockup);
+  sim.run(5800 - lockup - 1);
+  TEST_ASSERT_TRUE(sim.saber().effects().active(EFFECT_LOCKUP));
+  TEST_ASSERT_TRUE(sim.saber().blade().isOn());
+
+  sim.run(100);
+  TEST_ASSERT_FALSE(sim.saber().effects().active(EFFECT_LOCKUP));
+  TEST_ASSERT_TRUE(sim.saber().blade().isOn());
+
+  // a plain hold still turns it off
+  sim.button.press(6000, 900);
+  sim.run(6900 - sim.clock.millis());
+  TEST_ASSERT_FALSE(sim.saber().blade().isOn());
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_input_during_ignition);
+  RUN_TEST(test_ignition_frames);
+  RUN_TEST(test_frames_composed_when_due);
+  RUN_TEST(test_lockup_outlasts_hold);
+  RUN_TEST(test_audio_never_underruns);
+  return UNITY_END();
+}
@@ -0,0 +1,172 @@
+//
+// SaberConfig: the blob check, and config.json read by configFromJson(),
+// the converter shared by tools/config and the firmware fallback.
+//
+
+#include <string.h>
+#include <string>
+#include <unity.h>
+
+#include "SaberConfig.h"
+#include "IgnitionCurve.h"
+#include "SegmentMap.h"
+#include "LedRenderer.h"
+
+static SaberConfig cfg;
+static const char *unknown;
+
+// parsed in place, so from a copy
+static bool fromJson(const char *text) {
+  std::string json = text;
+  unknown = nullptr;
+  return configFromJson(&json[0], json.size(), cfg, &unknown);
+}
+
+
+void setUp() { configDefaults(cfg); }
+void tearDown() {}
+
+
+void test_crc32() {
+  TEST_ASSERT_EQUAL_HEX32(0xcbf43926, crc32("123456789", 9));
+  TEST_ASSERT_EQUAL_HEX32(0, crc32("", 0));
+}
+
+// json -> blob -> bytes on flash -> blob, every field survives
+void test_round_trip() {
+  TEST_ASSERT_TRUE(fromJson(
+    "{\"color\": \"#102030\", \"brightness\": 99, \"bladeLength\": 144, \"soundProfile\": 2,"
+    " \"ignitionMs\": 400, \"retractMs\": 500, \"ignitionCurve\": \"bounce\","
+    " \"retractCurve\": \"ease\", \"clashFlashMs\": 80, \"powerBudgetMa\": 1500,"
+    " \"strips\": 2, \"stripMode\": \"independent\", \"stripPins\": [4, 5],"
+    " \"stripReversed\": [0, 1], \"hostname\": \"blade\"}"));
+  TEST_ASSERT_NULL(unknown);
+
+  uint8_t flash[sizeof(SaberConfig)];
+  memcpy(flash, &cfg, sizeof(flash));
+  SaberConfig loaded;
+  memcpy(&loaded, flash, sizeof(loaded));
+  TEST_ASSERT_TRUE(configCheck(loaded));
+
+  TEST_ASSERT_EQUAL_HEX32(0x102030, loaded.color);
+  TEST_ASSERT_EQUAL(99, loaded.brightness);
+  TEST_ASSERT_EQUAL(144, loaded.numPixels);
+  TEST_ASSERT_EQUAL(2, loaded.soundProfile);
+  TEST_ASSERT_EQUAL(400, loaded.ignitionMs);
+  TEST_ASSERT_EQUAL(500, loaded.retractMs);
+  TEST_ASSERT_EQUAL(CURVE_BOUNCE, loaded.ignitionCurve);
+  TEST_ASSERT_EQUAL(CURVE_EASE_IN_OUT, loaded.retractCurve);
+  TEST_ASSERT_EQUAL(80, loaded.clashFlashMs);
+  TEST_ASSERT_EQUAL(1500, loaded.powerBudgetMa);
+  TEST_ASSERT_EQUAL(2, loaded.strips);
+  TEST_ASSERT_EQUAL(SEGMENT_INDEPENDENT, loaded.stripMode);
+  TEST_ASSERT_EQUAL(4, loaded.stripPins[0]);
+  TEST_ASSERT_EQUAL(5, loaded.stripPins[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x2, loaded.stripReversed);
+}
+
+// an empty object is the defaults, sealed
+void test_missing_keys_keep_defaults() {
+  SaberConfig defaults;
+  configDefaults(defaults);
+  TEST_ASSERT_TRUE(fromJson("{}"));
+  TEST_ASSERT_TRUE(configCheck(cfg));
+  TEST_ASSERT_EQUAL_MEMORY(&defaults, &cfg, sizeof(cfg));
+}
+
+void test_corrupted_blob_is_rejected() {
+  TEST_ASSERT_TRUE(configCheck(cfg));
+
+  // any flipped bit before the crc
+  for (size_t i = 0; i < offsetof(SaberConfig, crc); i++) {
+    SaberConfig bad = cfg;
+    ((uint8_t *)&bad)[i] ^= 0x10;
+    TEST_ASSERT_FALSE(configCheck(bad));
+  }
+  SaberConfig bad = cfg;
+  bad.crc ^= 1;
+  TEST_ASSERT_FALSE(configCheck(bad));
+
+  memset(&bad, 0xff, sizeof(bad));           // erased flash
+  TEST_ASSERT_FALSE(configCheck(bad));
+}
+
+// a blob of another version is refused even with a matching crc
+void test_wrong_version_is_rejected() {
+  SaberConfig other = cfg;
+  other.version = CONFIG_VERSION - 1;
+  other.crc = crc32(&other, offsetof(SaberConfig, crc));
+  TEST_ASSERT_FALSE(configCheck(other));
+
+  other = cfg;
+  other.magic = 0;
+  other.crc = crc32(&other, offsetof(SaberConfig, crc));
+  TEST_ASSERT_FALSE(configCheck(other));
+}
+
+// numbers out of range end up at the limit of their field, fractions are cut
+void test_numbers_are_clamped() {
+  TEST_ASSERT_TRUE(fromJson(
+    "{\"brightness\": 300, \"bladeLength\": 5000, \"ignitionMs\": 100000, \"retractMs\": -20,"
+    " \"strips\": 9, \"stripPins\": [99, 12.7], \"soundProfile\": 1.5}"));
+  TEST_ASSERT_EQUAL(255, cfg.brightness);
+  TEST_ASSERT_EQUAL(LED_MAX_PIXELS, cfg.numPixels);
+  TEST_ASSERT_EQUAL(65535, cfg.ignitionMs);
+  TEST_ASSERT_EQUAL(0, cfg.retractMs);
+  TEST_ASSERT_EQUAL(STRIP_MAX, cfg.strips);
+  TEST_ASSERT_EQUAL(39, cfg.stripPins[0]);
+  TEST_ASSERT_EQUAL(12, cfg.stripPins[1]);
+  TEST_ASSERT_EQUAL(1, cfg.soundProfile);
+  TEST_ASSERT_TRUE(configCheck(cfg));
+
+  TEST_ASSERT_TRUE(fromJson("{\"brightness\": 20.5, \"strips\": 0}"));
+  TEST_ASSERT_EQUAL(20, cfg.brightness);
+  TEST_ASSERT_EQUAL(1, cfg.strips);
+}
+
+// booleans, strings and objects where a number belongs are ignored, the
+// file still loads
+void test_wrong_types_keep_defaults() {
+  SaberConfig defaults;
+  configDefaults(defaults);
+  TEST_ASSERT_TRUE(fromJson(
+    "{\"brightness\": true, \"bladeLength\": \"long\", \"strips\": {\"count\": 2},"
+    " \"stripPins\": 4, \"wifi\": {\"ssid\": \"x\", \"on\": false}, \"stripReversed\": [true]}"));
+  TEST_ASSERT_EQUAL(defaults.brightness, cfg.brightness);
+  TEST_ASSERT_EQUAL(defaults.numPixels, cfg.numPixels);
+  TEST_ASSERT_EQUAL(defaults.strips, cfg.strips);
+  TEST_ASSERT_EQUAL(defaults.stripPins[0], cfg.stripPins[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x1, cfg.stripReversed);
+  TEST_ASSERT_NULL(unknown);
+}
+
+void test_unknown_names_are_reported() {
+  TEST_ASSERT_TRUE(fromJson("{\"color\": \"mauve\"}"));
+  TEST_ASSERT_EQUAL_STRING("color", unknown);
+  TEST_ASSERT_EQUAL_HEX32(0x0000ff, cfg.color);
+
+  TEST_ASSERT_TRUE(fromJson("{\"retractCurve\": \"zigzag\"}"));
+  TEST_ASSERT_EQUAL_STRING("retractCurve", unknown);
+  TEST_ASSERT_EQUAL(CURVE_SQRT, cfg.retractCurve);
+}
+
+void test_not_json_is_rejected() {
+  TEST_ASSERT_FALSE(fromJson(""));
+  TEST_ASSERT_FALSE(fromJson("{\"brightness\": "));
+  TEST_ASSERT_FALSE(fromJson("[1, 2]"));
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc32);
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_missing_keys_keep_defaults);
+  RUN_TEST(test_corrupted_blob_is_rejected);
+  RUN_TEST(test_wrong_version_is_rejected);
+  RUN_TEST(test_numbers_are_clamped);
+  RUN_TEST(test_wrong_types_keep_defaults);
+  RUN_TEST(test_unknown_names_are_reported);
+  RUN_TEST(test_not_json_is_rejected);
+  return UNITY_END();
+}
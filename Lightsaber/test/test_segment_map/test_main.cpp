@@ -0,0 +1,131 @@
+//
+// SegmentMap geometry, mirrored and independent, reversed strips, and
+// MultiStrip handing each strip its segment.
+//
+
+#include <unity.h>
+
+#include "SegmentMap.h"
+#include "MultiStrip.h"
+#include "NativeHal.h"
+
+static uint32_t frame[STRIP_MAX_PIXELS];
+static uint32_t out[STRIP_MAX_PIXELS];
+
+
+void setUp() {
+  for (int i = 0; i < STRIP_MAX_PIXELS; i++)
+    frame[i] = 1000 + i;
+}
+
+void tearDown() {}
+
+
+void test_mirrored() {
+  SegmentMap map;
+  TEST_ASSERT_TRUE(map.begin(144, 2, SEGMENT_MIRRORED, 0x2));
+  TEST_ASSERT_EQUAL(2, map.strips());
+  TEST_ASSERT_EQUAL(144, map.frameLength());
+  for (uint8_t s = 0; s < 2; s++) {
+    TEST_ASSERT_EQUAL(0, map.segment(s).first);
+    TEST_ASSERT_EQUAL(144, map.segment(s).count);
+  }
+  TEST_ASSERT_FALSE(map.segment(0).reversed);
+  TEST_ASSERT_TRUE(map.segment(1).reversed);
+
+  map.gather(0, frame, out);
+  TEST_ASSERT_EQUAL(1000, out[0]);
+  TEST_ASSERT_EQUAL(1143, out[143]);
+  map.gather(1, frame, out);
+  TEST_ASSERT_EQUAL(1143, out[0]);
+  TEST_ASSERT_EQUAL(1000, out[143]);
+}
+
+// equal segments, the last one takes the remainder
+void test_independent() {
+  SegmentMap map;
+  TEST_ASSERT_TRUE(map.begin(302, 3, SEGMENT_INDEPENDENT));
+  const uint16_t first[] = { 0, 100, 200 }, count[] = { 100, 100, 102 };
+  for (uint8_t s = 0; s < 3; s++) {
+    TEST_ASSERT_EQUAL(first[s], map.segment(s).first);
+    TEST_ASSERT_EQUAL(count[s], map.segment(s).count);
+    map.gather(s, frame, out);
+    for (uint16_t i = 0; i < count[s]; i++)
+      TEST_ASSERT_EQUAL(frame[first[s] + i], out[i]);
+  }
+}
+
+// a folded strip: the second half runs back from the tip
+void test_independent_reversed() {
+  SegmentMap map;
+  TEST_ASSERT_TRUE(map.begin(100, 2, SEGMENT_INDEPENDENT, 0x2));
+  map.gather(0, frame, out);
+  TEST_ASSERT_EQUAL(1000, out[0]);
+  TEST_ASSERT_EQUAL(1049, out[49]);
+  map.gather(1, frame, out);
+  TEST_ASSERT_EQUAL(1099, out[0]);
+  TEST_ASSERT_EQUAL(1050, out[49]);
+}
+
+// every frame pixel lands on exactly one strip pixel
+void test_independent_covers_frame() {
+  for (uint8_t strips = 1; strips <= STRIP_MAX; strips++) {
+    for (uint16_t pixels = strips; pixels <= STRIP_MAX_PIXELS; pixels += 37) {
+      SegmentMap map;
+      TEST_ASSERT_TRUE(map.begin(pixels, strips, SEGMENT_INDEPENDENT));
+      uint16_t next = 0;
+      for (uint8_t s = 0; s < strips; s++) {
+        TEST_ASSERT_EQUAL(next, map.segment(s).first);
+        TEST_ASSERT_TRUE(map.segment(s).count > 0);
+        next += map.segment(s).count;
+      }
+      TEST_ASSERT_EQUAL(pixels, next);
+    }
+  }
+}
+
+void test_geometry_limits() {
+  SegmentMap map;
+  TEST_ASSERT_FALSE(map.begin(50, 0, SEGMENT_MIRRORED));
+  TEST_ASSERT_FALSE(map.begin(50, STRIP_MAX + 1, SEGMENT_MIRRORED));
+  TEST_ASSERT_FALSE(map.begin(2, 3, SEGMENT_INDEPENDENT));
+  TEST_ASSERT_TRUE(map.begin(STRIP_MAX_PIXELS, 4, SEGMENT_INDEPENDENT));
+  TEST_ASSERT_FALSE(map.begin(STRIP_MAX_PIXELS + 1, 4, SEGMENT_INDEPENDENT));
+  // mirrored, every strip holds the whole frame
+  TEST_ASSERT_TRUE(map.begin(STRIP_MAX_PIXELS / 2, 2, SEGMENT_MIRRORED));
+  TEST_ASSERT_FALSE(map.begin(STRIP_MAX_PIXELS / 2 + 1, 2, SEGMENT_MIRRORED));
+  TEST_ASSERT_EQUAL(0, map.strips());
+}
+
+void test_multi_strip() {
+  SegmentMap map;
+  MemoryStrip strips[2];
+  MultiStrip multi(map);
+  TEST_ASSERT_TRUE(map.begin(120, 2, SEGMENT_INDEPENDENT, 0x1));
+  multi.attach(0, &strips[0]);
+  multi.attach(1, &strips[1]);
+
+  multi.show(frame, 119);      // short frame, nothing sent
+  TEST_ASSERT_EQUAL(0, strips[0].frames());
+
+  multi.show(frame, 120);
+  TEST_ASSERT_EQUAL(1, strips[0].frames());
+  TEST_ASSERT_EQUAL(1, strips[1].frames());
+  TEST_ASSERT_EQUAL(60, strips[0].frame().size());
+  TEST_ASSERT_EQUAL(1059, strips[0].frame()[0]);
+  TEST_ASSERT_EQUAL(1000, strips[0].frame()[59]);
+  TEST_ASSERT_EQUAL(1060, strips[1].frame()[0]);
+  TEST_ASSERT_EQUAL(1119, strips[1].frame()[59]);
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_mirrored);
+  RUN_TEST(test_independent);
+  RUN_TEST(test_independent_reversed);
+  RUN_TEST(test_independent_covers_frame);
+  RUN_TEST(test_geometry_limits);
+  RUN_TEST(test_multi_strip);
+  return UNITY_END();
+}
@@ -0,0 +1,128 @@
+//
+// SmoothSwing: crossfade gains, pitch and the gain ramp between blocks,
+// on loops with known content.
+//
+
+#include <stdlib.h>
+#include <unity.h>
+
+#include "SmoothSwing.h"
+#include "HumLoop.h"
+#include "MemoryPcm.h"
+
+#define LOOP_LENGTH 20000
+
+static int16_t level[LOOP_LENGTH];       // DC 10000
+static int16_t negative[LOOP_LENGTH];    // DC -10000
+static int16_t silence[LOOP_LENGTH];
+static int16_t ramp[LOOP_LENGTH];        // sample i is i
+
+static MemoryPcm pcmA, pcmB;
+static HumLoop loopA, loopB;
+static SmoothSwing swing;
+static int16_t out[SWING_BLOCK];
+
+static void begin(const int16_t *a, const int16_t *b) {
+  pcmA.begin(a, LOOP_LENGTH);
+  pcmB.begin(b, LOOP_LENGTH);
+  loopA.begin(pcmA, 0);
+  loopB.begin(pcmB, 0);
+  swing.begin(loopA, loopB);
+}
+
+// read blocks until the gain ramps have settled
+static void settle(uint16_t speed) {
+  swing.setSpeed(speed);
+  for (int i = 0; i < 3; i++)
+    swing.read(out, SWING_BLOCK);
+}
+
+
+void setUp() {
+  for (int i = 0; i < LOOP_LENGTH; i++) {
+    level[i] = 10000;
+    negative[i] = -10000;
+    silence[i] = 0;
+    ramp[i] = (int16_t)i;
+  }
+}
+
+void tearDown() {}
+
+
+void test_rest_plays_loop_a() {
+  begin(level, silence);
+  settle(0);
+  for (int i = 0; i < SWING_BLOCK; i++)
+    TEST_ASSERT_INT_WITHIN(1, 10000, out[i]);
+}
+
+void test_full_speed_plays_loop_b() {
+  begin(silence, level);
+  settle(SWING_MAX_SPEED * 2);
+  for (int i = 0; i < SWING_BLOCK; i++)
+    TEST_ASSERT_INT_WITHIN(1, 10000, out[i]);
+}
+
+// half way both loops play at 1/sqrt(2)
+void test_equal_power_crossfade() {
+  begin(level, level);
+  settle(SWING_MAX_SPEED / 2);
+  TEST_ASSERT_INT_WITHIN(5, 14142, out[SWING_BLOCK / 2]);
+}
+
+// at full speed the loops run 15% fast
+void test_pitch() {
+  begin(silence, ramp);
+  settle(0);
+  TEST_ASSERT_INT_WITHIN(1, 1, out[1] - out[0] + 1);    // silent
+  settle(SWING_MAX_SPEED);
+  int32_t step = out[200] - out[100];
+  TEST_ASSERT_INT_WITHIN(1, (100 * (65536 + SWING_MAX_PITCH)) >> 16, step);
+}
+
+// a jump in speed is ramped across the next block, no click
+void test_gain_ramp() {
+  begin(level, negative);
+  settle(0);
+  int16_t last = out[SWING_BLOCK - 1];
+  swing.setSpeed(SWING_MAX_SPEED);
+  swing.read(out, SWING_BLOCK);
+  int maxStep = abs(out[0] - last);
+  for (int i = 1; i < SWING_BLOCK; i++)
+    if (abs(out[i] - out[i - 1]) > maxStep)
+      maxStep = abs(out[i] - out[i - 1]);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * 20000 / SWING_BLOCK, maxStep);
+  TEST_ASSERT_INT_WITHIN(100, -10000, out[SWING_BLOCK - 1]);
+}
+
+void test_never_runs_dry() {
+  begin(ramp, ramp);
+  swing.setSpeed(SWING_MAX_SPEED);
+  for (int i = 0; i < 4 * LOOP_LENGTH / SWING_BLOCK; i++)
+    TEST_ASSERT_EQUAL(SWING_BLOCK, swing.read(out, SWING_BLOCK));
+  TEST_ASSERT_EQUAL(SWING_BLOCK, swing.read(out, SWING_BLOCK * 2));
+}
+
+void test_seek_restarts_at_rest() {
+  begin(ramp, silence);
+  settle(SWING_MAX_SPEED);
+  TEST_ASSERT_TRUE(swing.seek(0));
+  swing.setSpeed(0);
+  swing.read(out, 10);
+  TEST_ASSERT_INT_WITHIN(1, 0, out[0]);
+  TEST_ASSERT_INT_WITHIN(1, 9, out[9]);
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_rest_plays_loop_a);
+  RUN_TEST(test_full_speed_plays_loop_b);
+  RUN_TEST(test_equal_power_crossfade);
+  RUN_TEST(test_pitch);
+  RUN_TEST(test_gain_ramp);
+  RUN_TEST(test_never_runs_dry);
+  RUN_TEST(test_seek_restarts_at_rest);
+  return UNITY_END();
+}
@@ -0,0 +1,177 @@
+//
+// SoundBank: data/*.wav packed by the host packer and read back the way the
+// firmware does, and images the firmware has to refuse.
+//
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "SoundBank.h"
+#include "SoundBankWriter.h"
+#include "WavReader.h"
+
+#define TONE_RATE  22050
+#define TONE_HZ    440.0
+#define TONE_LEVEL 10000
+
+static const std::vector<std::string> assets = {
+  "data/Hum-4.wav", "data/hit.wav", "data/idle.wav",
+  "data/off.wav", "data/on.wav", "data/swing.wav",
+};
+
+static std::vector<uint8_t> image;
+
+
+class StdioSource : public ByteSource {
+  public:
+    ~StdioSource() { if (f) fclose(f); }
+    bool open(const char *path) { f = fopen(path, "rb"); return f != nullptr; }
+    size_t read(uint8_t *data, size_t len) override { return fread(data, 1, len, f); }
+    bool seek(uint32_t pos) override { return fseek(f, pos, SEEK_SET) == 0; }
+    uint32_t size() override {
+      long pos = ftell(f);
+      fseek(f, 0, SEEK_END);
+      long size = ftell(f);
+      fseek(f, pos, SEEK_SET);
+      return size;
+    }
+  private:
+    FILE *f = nullptr;
+};
+
+
+// the asset decoded on its own, without the packer
+static std::vector<int16_t> decode(const std::string &path) {
+  StdioSource source;
+  WavReader wav;
+  TEST_ASSERT_TRUE_MESSAGE(source.open(path.c_str()), path.c_str());
+  TEST_ASSERT_TRUE_MESSAGE(wav.begin(source), path.c_str());
+  std::vector<int16_t> raw(wav.length());
+  TEST_ASSERT_EQUAL(raw.size(), wav.read(raw.data(), raw.size()));
+  return soundBankResample(raw, wav.sampleRate(), SOUNDBANK_RATE);
+}
+
+static SoundBankHeader &header(std::vector<uint8_t> &bank) {
+  return *(SoundBankHeader *)bank.data();
+}
+
+static SoundBankEntry &entry(std::vector<uint8_t> &bank, int index) {
+  return ((SoundBankEntry *)(bank.data() + sizeof(SoundBankHeader)))[index];
+}
+
+
+void setUp() {
+  if (image.empty()) {
+    std::string error;
+    TEST_ASSERT_TRUE_MESSAGE(soundBankPack(assets, image, error), error.c_str());
+  }
+}
+
+void tearDown() {}
+
+
+void test_packed_assets_read_back() {
+  SoundBank bank;
+  TEST_ASSERT_TRUE(bank.begin(image.data(), image.size()));
+  TEST_ASSERT_EQUAL(assets.size(), bank.count());
+  TEST_ASSERT_EQUAL(SOUNDBANK_RATE, bank.sampleRate());
+
+  for (const std::string &path : assets) {
+    std::string name = soundBankName(path);
+    int index = bank.find(name.c_str());
+    TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(0, index, name.c_str());
+    TEST_ASSERT_EQUAL_STRING(name.c_str(), bank.name(index));
+
+    std::vector<int16_t> pcm = decode(path);
+    TEST_ASSERT_EQUAL_MESSAGE(pcm.size(), bank.length(index), name.c_str());
+    TEST_ASSERT_EQUAL(0, ((const uint8_t *)bank.samples(index) - image.data()) % SOUNDBANK_ALIGN);
+    TEST_ASSERT_EQUAL_INT16_ARRAY_MESSAGE(pcm.data(), bank.samples(index), pcm.size(), name.c_str());
+  }
+  TEST_ASSERT_EQUAL(-1, bank.find("missing"));
+}
+
+// a tone keeps its pitch and level through the resampler
+void test_resample_keeps_a_tone() {
+  std::vector<int16_t> tone(TONE_RATE / 2);
+  for (size_t i = 0; i < tone.size(); i++)
+    tone[i] = (int16_t)lround(TONE_LEVEL * sin(2 * M_PI * TONE_HZ * i / TONE_RATE));
+
+  std::vector<int16_t> out = soundBankResample(tone, TONE_RATE, SOUNDBANK_RATE);
+  TEST_ASSERT_EQUAL(tone.size() * SOUNDBANK_RATE / TONE_RATE, out.size());
+
+  // away from the edges, where the filter runs out of input
+  int worst = 0;
+  for (size_t i = 100; i < out.size() - 100; i++) {
+    int expected = (int)lround(TONE_LEVEL * sin(2 * M_PI * TONE_HZ * i / SOUNDBANK_RATE));
+    worst = std::max(worst, abs(out[i] - expected));
+  }
+  TEST_ASSERT_LESS_OR_EQUAL(TONE_LEVEL / 100, worst);
+}
+
+void test_bad_magic_is_rejected() {
+  std::vector<uint8_t> bad = image;
+  header(bad).magic ^= 1;
+  SoundBank bank;
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+  TEST_ASSERT_EQUAL(0, bank.count());
+}
+
+void test_bad_version_is_rejected() {
+  std::vector<uint8_t> bad = image;
+  header(bad).version = SOUNDBANK_VERSION + 1;
+  SoundBank bank;
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+}
+
+void test_truncated_image_is_rejected() {
+  SoundBank bank;
+  TEST_ASSERT_FALSE(bank.begin(image.data(), image.size() - 1));
+  TEST_ASSERT_FALSE(bank.begin(image.data(), SOUNDBANK_DATA_START - 1));
+}
+
+void test_entry_out_of_range_is_rejected() {
+  SoundBank bank;
+
+  std::vector<uint8_t> bad = image;
+  entry(bad, 1).offset = header(bad).size + SOUNDBANK_ALIGN;
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+
+  // one sample past the end of the image
+  bad = image;
+  int last = header(bad).count - 1;
+  entry(bad, last).length = (header(bad).size - entry(bad, last).offset) / 2 + 1;
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+
+  // offset + length wrapping around 32 bits
+  bad = image;
+  entry(bad, 0).length = 0x80000000u;
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+
+  // inside the index table, and not aligned
+  bad = image;
+  entry(bad, 0).offset = sizeof(SoundBankHeader);
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+  bad = image;
+  entry(bad, 0).offset += 2;
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+
+  bad = image;
+  header(bad).count = SOUNDBANK_MAX_SOUNDS + 1;
+  TEST_ASSERT_FALSE(bank.begin(bad.data(), bad.size()));
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_packed_assets_read_back);
+  RUN_TEST(test_resample_keeps_a_tone);
+  RUN_TEST(test_bad_magic_is_rejected);
+  RUN_TEST(test_bad_version_is_rejected);
+  RUN_TEST(test_truncated_image_is_rejected);
+  RUN_TEST(test_entry_out_of_range_is_rejected);
+  return UNITY_END();
+}
@@ -0,0 +1,118 @@
+//
+// SpscRing: single threaded bookkeeping, then a producer and a consumer
+// thread moving millions of items through a small ring.
+//
+
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+#include <unity.h>
+
+#include "SpscRing.h"
+
+#define STRESS_ITEMS 10000000u
+
+// the other side needs the CPU, the test host may have a single core
+static void waitABit() {
+  std::this_thread::sleep_for(std::chrono::microseconds(20));
+}
+
+
+void setUp() {}
+void tearDown() {}
+
+
+void test_space_and_available() {
+  SpscRing<int32_t, 8> ring;
+  int32_t data[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  int32_t out[10];
+
+  TEST_ASSERT_EQUAL(8, ring.space());
+  TEST_ASSERT_EQUAL(0, ring.available());
+  TEST_ASSERT_EQUAL(8, ring.write(data, 10));
+  TEST_ASSERT_EQUAL(0, ring.space());
+  TEST_ASSERT_FALSE(ring.push(data[0]));
+
+  TEST_ASSERT_EQUAL(5, ring.read(out, 5));
+  TEST_ASSERT_EQUAL(3, ring.available());
+  TEST_ASSERT_EQUAL(5, ring.space());
+  TEST_ASSERT_EQUAL(0, out[0]);
+  TEST_ASSERT_EQUAL(4, out[4]);
+}
+
+// a block across the end of the buffer comes out in order
+void test_wrap_around() {
+  SpscRing<int32_t, 8> ring;
+  int32_t data[6] = { 10, 11, 12, 13, 14, 15 };
+  int32_t out[6];
+
+  for (int round = 0; round < 5; round++) {
+    TEST_ASSERT_EQUAL(6, ring.write(data, 6));
+    TEST_ASSERT_EQUAL(6, ring.read(out, 6));
+    TEST_ASSERT_EQUAL_MEMORY(data, out, sizeof(data));
+  }
+}
+
+void test_reset() {
+  SpscRing<uint8_t, 4> ring;
+  uint8_t item = 7;
+  ring.push(item);
+  ring.reset();
+  TEST_ASSERT_EQUAL(0, ring.available());
+  TEST_ASSERT_FALSE(ring.pop(item));
+}
+
+// a sequence written in uneven blocks arrives complete and in order
+void test_two_threads() {
+  static SpscRing<uint32_t, 1024> ring;
+  uint32_t received = 0;
+  bool ordered = true;
+
+  std::thread producer([]() {
+    uint32_t block[300];
+    uint32_t next = 0;
+    uint32_t random = 1;
+    while (next < STRESS_ITEMS) {
+      random = random * 1664525 + 1013904223;
+      uint32_t count = 1 + (random >> 24) % 300;
+      if (count > STRESS_ITEMS - next)
+        count = STRESS_ITEMS - next;
+      for (uint32_t i = 0; i < count; i++)
+        block[i] = next + i;
+      uint32_t n = ring.write(block, count);
+      if (n == 0)
+        waitABit();     // full
+      next += n;
+    }
+  });
+
+  std::thread consumer([&]() {
+    uint32_t block[256];
+    uint32_t random = 7;
+    while (received < STRESS_ITEMS) {
+      random = random * 1664525 + 1013904223;
+      size_t n = ring.read(block, 1 + (random >> 24) % 256);
+      if (n == 0)
+        waitABit();     // empty
+      for (size_t i = 0; i < n; i++)
+        ordered &= block[i] == received + i;
+      received += n;
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  TEST_ASSERT_TRUE(ordered);
+  TEST_ASSERT_EQUAL_UINT32(STRESS_ITEMS, received);
+  TEST_ASSERT_EQUAL(0, ring.available());
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_space_and_available);
+  RUN_TEST(test_wrap_around);
+  RUN_TEST(test_reset);
+  RUN_TEST(test_two_threads);
+  return UNITY_END();
+}
@@ -0,0 +1,137 @@
+//
+// Ws2812Encoder: symbol layout, GRB byte order, MSB first bit order and
+// the number of symbols written for a frame.
+//
+
+#include <stdlib.h>
+#include <unity.h>
+
+#include "Ws2812Encoder.h"
+
+// the RmtStrip timings, 25 ns ticks
+#define T0H 16
+#define T0L 34
+#define T1H 32
+#define T1L 18
+
+static uint32_t high(uint32_t symbol) { return symbol & 0x7fff; }
+static uint32_t low(uint32_t symbol) { return symbol >> 16 & 0x7fff; }
+
+// the bit a symbol stands for, fails on anything but the two symbols
+static int bitOf(uint32_t symbol) {
+  if (high(symbol) == T0H && low(symbol) == T0L)
+    return 0;
+  if (high(symbol) == T1H && low(symbol) == T1L)
+    return 1;
+  TEST_FAIL_MESSAGE("neither a 0 nor a 1 symbol");
+  return -1;
+}
+
+// 24 symbols back to the byte sequence on the wire
+static uint32_t wire(const uint32_t *symbols) {
+  uint32_t bits = 0;
+  for (int i = 0; i < WS2812_SYMBOLS_PER_PIXEL; i++)
+    bits = bits << 1 | bitOf(symbols[i]);
+  return bits;
+}
+
+static const Ws2812Encoder encoder(T0H, T0L, T1H, T1L);
+
+
+void setUp() {}
+void tearDown() {}
+
+
+// high time first with level 1 in bit 15, low time with level 0 in bit 31
+void test_symbol_layout() {
+  uint32_t s = Ws2812Encoder::symbol(T1H, T1L);
+  TEST_ASSERT_EQUAL_HEX32(T1H | 0x8000 | (uint32_t)T1L << 16, s);
+  TEST_ASSERT_TRUE(s & 0x8000);
+  TEST_ASSERT_FALSE(s & 0x80000000);
+
+  // durations are 15 bits, they never reach into the level bits
+  s = Ws2812Encoder::symbol(0xffff, 0xffff);
+  TEST_ASSERT_EQUAL_HEX32(0x7fffffff, s);
+}
+
+void test_bit_durations() {
+  uint32_t symbols[WS2812_SYMBOLS_PER_PIXEL];
+  uint32_t frame[] = { 0x000000 };
+  encoder.encode(frame, 1, symbols);
+  for (uint32_t s : symbols) {
+    TEST_ASSERT_EQUAL(T0H, high(s));
+    TEST_ASSERT_EQUAL(T0L, low(s));
+    TEST_ASSERT_EQUAL_HEX32(0x8000, s & 0x80008000);
+  }
+
+  frame[0] = 0xffffff;
+  encoder.encode(frame, 1, symbols);
+  for (uint32_t s : symbols) {
+    TEST_ASSERT_EQUAL(T1H, high(s));
+    TEST_ASSERT_EQUAL(T1L, low(s));
+    TEST_ASSERT_EQUAL_HEX32(0x8000, s & 0x80008000);
+  }
+}
+
+// 0x00RRGGBB goes out as green, red, blue
+void test_grb_byte_order() {
+  uint32_t symbols[WS2812_SYMBOLS_PER_PIXEL];
+  uint32_t frame[] = { 0x123456 };
+  encoder.encode(frame, 1, symbols);
+  TEST_ASSERT_EQUAL_HEX32(0x341256, wire(symbols));
+
+  srand(1);
+  for (int i = 0; i < 1000; i++) {
+    uint32_t c = ((uint32_t)rand() << 8 ^ rand()) & 0xffffff;
+    frame[0] = c;
+    encoder.encode(frame, 1, symbols);
+    TEST_ASSERT_EQUAL_HEX32((c >> 8 & 0xff) << 16 | (c >> 16 & 0xff) << 8 | (c & 0xff), wire(symbols));
+  }
+}
+
+// a single bit set lands on the symbol for its position, MSB first
+void test_msb_first() {
+  uint32_t symbols[WS2812_SYMBOLS_PER_PIXEL];
+  const struct { uint32_t color; int symbol; } cases[] = {
+    { 0x008000, 0 }, { 0x000100, 7 },      // green
+    { 0x800000, 8 }, { 0x010000, 15 },     // red
+    { 0x000080, 16 }, { 0x000001, 23 },    // blue
+  };
+  for (const auto &c : cases) {
+    encoder.encode(&c.color, 1, symbols);
+    for (int i = 0; i < WS2812_SYMBOLS_PER_PIXEL; i++)
+      TEST_ASSERT_EQUAL(i == c.symbol, bitOf(symbols[i]));
+  }
+}
+
+// exactly 24 symbols per pixel, pixel after pixel, nothing past the end
+void test_symbol_count() {
+  static uint32_t frame[300];
+  static uint32_t symbols[301 * WS2812_SYMBOLS_PER_PIXEL];
+  for (uint16_t i = 0; i < 300; i++)
+    frame[i] = i * 0x010203;
+
+  const uint16_t counts[] = { 0, 1, 7, 300 };
+  for (uint16_t count : counts) {
+    for (uint32_t &s : symbols)
+      s = 0xdeadbeef;
+    encoder.encode(frame, count, symbols);
+    for (uint16_t i = 0; i < count; i++) {
+      uint32_t c = frame[i];
+      uint32_t grb = (c >> 8 & 0xff) << 16 | (c >> 16 & 0xff) << 8 | (c & 0xff);
+      TEST_ASSERT_EQUAL_HEX32(grb, wire(symbols + i * WS2812_SYMBOLS_PER_PIXEL));
+    }
+    TEST_ASSERT_EQUAL_HEX32(0xdeadbeef, symbols[count * WS2812_SYMBOLS_PER_PIXEL]);
+  }
+}
+
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_symbol_layout);
+  RUN_TEST(test_bit_durations);
+  RUN_TEST(test_grb_byte_order);
+  RUN_TEST(test_msb_first);
+  RUN_TEST(test_symbol_count);
+  return UNITY_END();
+}
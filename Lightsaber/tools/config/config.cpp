@@ -0,0 +1,155 @@
+//
+// Host tool converting config.json into the binary config blob (see SaberConfig.h).
+//
+// Build on Linux from the Lightsaber directory, with ArduinoJson 6 (header
+// only, .pio/libdeps/native/ArduinoJson/src after a native build):
+//   g++ -std=c++17 -O2 -I<ArduinoJson>/src -Ilib/SaberConfig -Ilib/Blade -Ilib/MultiStrip
+//       -Ilib/LedRenderer -Ilib/Color -Ilib/PowerLimiter -Ilib/FixedMath -o config
+//       tools/config/config.cpp lib/SaberConfig/SaberConfig.cpp lib/MultiStrip/SegmentMap.cpp
+//
+// Usage:
+//   config pack <config.json> <config.bin>   convert, print the load times
+//   config dump <config.bin>                 check and print a blob
+//
+// The json is read by configFromJson(), the same code the firmware falls
+// back to without a blob, so both accept the same files.
+//
+// Keys: color ("blue" or "#rrggbb"), brightness, bladeLength, soundProfile
+// (hum set of the config profile, 0 is Hum-4 / idle), ignitionMs, retractMs, ignitionCurve, retractCurve ("sqrt", "ease",
+// "bounce", "flicker"), clashFlashMs, strips, stripMode ("mirrored",
+// "independent"), stripPins ([9, 10]), stripReversed ([0, 1]) and
+// powerBudgetMa (0 = unlimited).
+// Missing and unknown keys are ignored, numbers are clamped to their field.
+// Flash the blob with
+//   esptool.py --chip esp32 write_flash 0x3FF000 config.bin
+// (offset of the config partition in partitions.csv).
+//
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "SaberConfig.h"
+#include "SegmentMap.h"
+#include "LedRenderer.h"
+
+
+bool readFile(const char *path, std::string &text) {
+  FILE *f = fopen(path, "rb");
+  if (f == nullptr)
+    return false;
+  char buf[1024];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    text.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+
+// average time of one fn() call over rounds, in ns
+template <typename F>
+double timeNs(int rounds, F fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++)
+    fn();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+
+int pack(const char *jsonPath, const char *binPath) {
+  std::string text;
+  if (!readFile(jsonPath, text)) {
+    fprintf(stderr, "can't read %s\n", jsonPath);
+    return 1;
+  }
+  if (text.size() > CONFIG_JSON_MAX) {
+    fprintf(stderr, "%s: %zu bytes, the firmware reads at most %d\n", jsonPath, text.size(), CONFIG_JSON_MAX);
+    return 1;
+  }
+
+  // parsed in place, so every parse gets a fresh copy
+  SaberConfig cfg;
+  std::string json = text;
+  const char *unknown = nullptr;
+  if (!configFromJson(&json[0], json.size(), cfg, &unknown)) {
+    fprintf(stderr, "%s: not a json object\n", jsonPath);
+    return 1;
+  }
+  if (unknown)
+    fprintf(stderr, "%s: unknown value, using the default\n", unknown);
+
+  SegmentMap map;
+  if (!map.begin(cfg.numPixels, cfg.strips, (SegmentMode)cfg.stripMode, cfg.stripReversed)) {
+    fprintf(stderr, "%u pixels on %u strips do not fit, at most %d pixels over all strips\n",
+            cfg.numPixels, cfg.strips, STRIP_MAX_PIXELS);
+    return 1;
+  }
+
+  FILE *f = fopen(binPath, "wb");
+  if (f == nullptr || fwrite(&cfg, sizeof(cfg), 1, f) != 1) {
+    fprintf(stderr, "can't write %s\n", binPath);
+    return 1;
+  }
+  fclose(f);
+
+  // both load paths of the device, on the host: the json fallback and the
+  // check of the binary blob
+  SaberConfig parsed;
+  double parseNs = timeNs(10000, [&]() {
+    json = text;
+    configFromJson(&json[0], json.size(), parsed);
+  });
+  volatile int valid = 0;
+  double checkNs = timeNs(100000, [&]() { valid = valid + configCheck(cfg); });
+
+  printf("%s: %zu bytes, crc %08x\n", binPath, sizeof(cfg), cfg.crc);
+  printf("load: json %.0f ns, binary %.0f ns\n", parseNs, checkNs);
+  return 0;
+}
+
+
+int dump(const char *binPath) {
+  std::string blob;
+  if (!readFile(binPath, blob) || blob.size() != sizeof(SaberConfig)) {
+    fprintf(stderr, "%s: not a config blob\n", binPath);
+    return 1;
+  }
+
+  SaberConfig cfg;
+  memcpy(&cfg, blob.data(), sizeof(cfg));
+
+  if (!configCheck(cfg)) {
+    fprintf(stderr, "%s: bad magic, version or crc\n", binPath);
+    return 1;
+  }
+  printf("version        %u\n", cfg.version);
+  printf("color          #%06x\n", cfg.color);
+  printf("brightness     %u\n", cfg.brightness);
+  printf("soundProfile   %u\n", cfg.soundProfile);
+  printf("bladeLength    %u\n", cfg.numPixels);
+  printf("ignitionMs     %u\n", cfg.ignitionMs);
+  printf("retractMs      %u\n", cfg.retractMs);
+  printf("ignitionCurve  %u\n", cfg.ignitionCurve);
+  printf("retractCurve   %u\n", cfg.retractCurve);
+  printf("clashFlashMs   %u\n", cfg.clashFlashMs);
+  printf("strips         %u %s\n", cfg.strips, cfg.stripMode == SEGMENT_MIRRORED ? "mirrored" : "independent");
+  printf("powerBudgetMa  %u\n", cfg.powerBudgetMa);
+  for (int i = 0; i < cfg.strips && i < STRIP_MAX; i++)
+    printf("  strip %d      pin %u%s\n", i, cfg.stripPins[i], cfg.stripReversed & (1 << i) ? " reversed" : "");
+  return 0;
+}
+
+
+int main(int argc, char **argv) {
+  if (argc == 4 && strcmp(argv[1], "pack") == 0)
+    return pack(argv[2], argv[3]);
+  if (argc == 3 && strcmp(argv[1], "dump") == 0)
+    return dump(argv[2]);
+
+  fprintf(stderr, "usage: config pack <config.json> <config.bin>\n"
+                  "       config dump <config.bin>\n");
+  return 2;
+}
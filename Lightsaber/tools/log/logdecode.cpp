@@ -0,0 +1,188 @@
+//
+// Host tool printing the deferred log records (see Log.h) as text.
+//
+// Build on Linux from the Lightsaber directory:
+//   g++ -std=c++17 -O2 -Ilib/Log -o logdecode tools/log/logdecode.cpp
+//
+// Usage:
+//   logdecode <source dir or file>... < serial.log
+//
+// The record only carries the FNV-1a hash of its format string. The tool
+// collects every LOG_ERROR/WARN/INFO/DEBUG("...") format in the given
+// sources, hashes it the same way and prints the records with their text.
+// Everything else in the log passes through unchanged. Build the firmware
+// and decode from the same tree, otherwise formats may be missing.
+//
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Log.h"
+
+
+static const char *levelNames[] = { "", "ERROR", "WARN", "INFO", "DEBUG" };
+
+std::map<uint32_t, std::string> formats;
+
+
+// the C string literal starting at s (after the quote), escapes resolved
+std::string literal(const char *&s) {
+  std::string out;
+  for (; *s && *s != '"'; s++) {
+    if (*s != '\\') {
+      out += *s;
+      continue;
+    }
+    switch (*++s) {
+      case 'n': out += '\n'; break;
+      case 't': out += '\t'; break;
+      case 'r': out += '\r'; break;
+      case '0': out += '\0'; break;
+      default:  out += *s; break;
+    }
+  }
+  return out;
+}
+
+
+void scan(const std::filesystem::path &path) {
+  std::ifstream file(path);
+  std::stringstream text;
+  text << file.rdbuf();
+  std::string source = text.str();
+
+  for (const char *level : { "LOG_ERROR", "LOG_WARN", "LOG_INFO", "LOG_DEBUG" }) {
+    size_t at = 0;
+    while ((at = source.find(level, at)) != std::string::npos) {
+      const char *p = source.c_str() + at + strlen(level);
+      at++;
+      while (isspace((unsigned char)*p))
+        p++;
+      if (*p++ != '(')
+        continue;
+      while (isspace((unsigned char)*p))
+        p++;
+      if (*p++ != '"')
+        continue;                     // the macro definitions themselves
+      std::string format = literal(p);
+      formats[logHash(format.c_str())] = format;
+    }
+  }
+}
+
+
+void scanAll(const char *root) {
+  std::filesystem::path path(root);
+  if (!std::filesystem::is_directory(path)) {
+    scan(path);
+    return;
+  }
+  for (const auto &entry : std::filesystem::recursive_directory_iterator(path)) {
+    std::string ext = entry.path().extension().string();
+    if (entry.is_regular_file() && (ext == ".cpp" || ext == ".h" || ext == ".ino"))
+      scan(entry.path());
+  }
+}
+
+
+// printf the format with the 32 bit arguments, each conversion takes one
+std::string format(const std::string &fmt, const std::vector<uint32_t> &args) {
+  std::string out;
+  size_t next = 0;
+  char buf[64];
+
+  for (size_t i = 0; i < fmt.size(); i++) {
+    if (fmt[i] != '%') {
+      out += fmt[i];
+      continue;
+    }
+    if (fmt[i + 1] == '%') {
+      out += '%';
+      i++;
+      continue;
+    }
+    // flags, width and precision are kept, length modifiers dropped
+    std::string spec = "%";
+    for (i++; i < fmt.size() && strchr("-+ #0123456789.", fmt[i]); i++)
+      spec += fmt[i];
+    while (i < fmt.size() && strchr("hlLzjt", fmt[i]))
+      i++;
+    if (i == fmt.size())
+      break;
+    char conversion = fmt[i];
+    spec += conversion;
+
+    if (conversion == 's') {
+      out += "<str>";
+      next++;
+      continue;
+    }
+    if (next >= args.size()) {
+      out += "<?>";
+      continue;
+    }
+    uint32_t arg = args[next++];
+    if (strchr("di", conversion)) {
+      snprintf(buf, sizeof(buf), spec.c_str(), (int32_t)arg);
+    } else if (strchr("fFeEgG", conversion)) {
+      float f;
+      memcpy(&f, &arg, sizeof(f));
+      snprintf(buf, sizeof(buf), spec.c_str(), (double)f);
+    } else if (strchr("uxXoc", conversion)) {
+      snprintf(buf, sizeof(buf), spec.c_str(), arg);
+    } else {
+      snprintf(buf, sizeof(buf), "%x", arg);
+    }
+    out += buf;
+  }
+  return out;
+}
+
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: logdecode <source dir or file>... < serial.log\n");
+    return 2;
+  }
+  for (int i = 1; i < argc; i++)
+    scanAll(argv[i]);
+  fprintf(stderr, "%zu log formats\n", formats.size());
+
+  char line[512];
+  while (fgets(line, sizeof(line), stdin)) {
+    char *p = strstr(line, "log ");
+    unsigned id, time, level;
+    int n = 0;
+    if (p == nullptr || sscanf(p, "log %8x %x %u%n", &id, &time, &level, &n) != 3 || p[12] != ' ') {
+      fputs(line, stdout);
+      continue;
+    }
+
+    std::vector<uint32_t> args;
+    unsigned arg;
+    int used;
+    for (const char *a = p + n; sscanf(a, " %x%n", &arg, &used) == 1; a += used)
+      args.push_back(arg);
+
+    fwrite(line, 1, p - line, stdout);
+    printf("%u.%03u %-5s ", time / 1000, time % 1000, level < 5 ? levelNames[level] : "?");
+    auto it = formats.find(id);
+    if (it != formats.end()) {
+      printf("%s\n", format(it->second, args).c_str());
+    } else {
+      printf("unknown format %08x", id);
+      for (uint32_t a : args)
+        printf(" %x", a);
+      printf("\n");
+    }
+  }
+  return 0;
+}
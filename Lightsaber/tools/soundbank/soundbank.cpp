@@ -0,0 +1,91 @@
+//
+// Host tool packing wav files into a sound bank image (see SoundBank.h).
+//
+// Build on Linux from the Lightsaber directory:
+//   g++ -std=c++17 -O2 -Ilib/Pcm -Ilib/SoundBank -o soundbank tools/soundbank/soundbank.cpp
+//       lib/Pcm/WavReader.cpp lib/SoundBank/SoundBank.cpp lib/SoundBank/SoundBankWriter.cpp
+//
+// Usage:
+//   soundbank pack <bank.bin> <file.wav>...   pack, the name is the file name without .wav
+//   soundbank list <bank.bin>
+//
+// Sounds are mixed down to mono and resampled to 16 kHz (SoundBankWriter.h).
+// Only 16 bit PCM wav is read, convert mp3 files to wav first. The packer is
+// tested against data/*.wav by test/test_sound_bank. Flash the image with
+//   esptool.py --chip esp32 write_flash 0x2F0000 bank.bin
+// (offset of the soundbank partition in partitions.csv).
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "SoundBank.h"
+#include "SoundBankWriter.h"
+
+
+static bool readFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path, "rb");
+  if (f == nullptr)
+    return false;
+  fseek(f, 0, SEEK_END);
+  data.resize(ftell(f));
+  fseek(f, 0, SEEK_SET);
+  bool ok = fread(data.data(), 1, data.size(), f) == data.size();
+  fclose(f);
+  return ok;
+}
+
+
+static int pack(const char *bankPath, int count, char **files) {
+  std::vector<uint8_t> image;
+  std::string error;
+  if (!soundBankPack(std::vector<std::string>(files, files + count), image, error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  SoundBank bank;
+  bank.begin(image.data(), image.size());
+  for (int i = 0; i < bank.count(); i++) {
+    printf("%-16s %7u samples at 0x%06x\n", bank.name(i), bank.length(i),
+           (unsigned)((const uint8_t *)bank.samples(i) - image.data()));
+  }
+
+  FILE *f = fopen(bankPath, "wb");
+  if (f == nullptr || fwrite(image.data(), 1, image.size(), f) != image.size()) {
+    fprintf(stderr, "%s: write failed\n", bankPath);
+    return 1;
+  }
+  fclose(f);
+  printf("%s: %d sounds, %zu bytes\n", bankPath, count, image.size());
+  return 0;
+}
+
+
+static int list(const char *bankPath) {
+  std::vector<uint8_t> image;
+  SoundBank bank;
+  if (!readFile(bankPath, image) || !bank.begin(image.data(), image.size())) {
+    fprintf(stderr, "%s: not a valid sound bank\n", bankPath);
+    return 1;
+  }
+  for (int i = 0; i < bank.count(); i++) {
+    printf("%2d %-16s %7u samples %6.2fs\n", i, bank.name(i), bank.length(i),
+           (double)bank.length(i) / bank.sampleRate());
+  }
+  return 0;
+}
+
+
+int main(int argc, char **argv) {
+  if (argc >= 4 && strcmp(argv[1], "pack") == 0)
+    return pack(argv[2], argc - 3, argv + 3);
+  if (argc == 3 && strcmp(argv[1], "list") == 0)
+    return list(argv[2]);
+
+  fprintf(stderr, "usage: soundbank pack <bank.bin> <file.wav>...\n"
+                  "       soundbank list <bank.bin>\n");
+  return 2;
+}
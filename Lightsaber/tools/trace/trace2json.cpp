@@ -0,0 +1,130 @@
+//
+// Host tool converting a trace dump (see Trace.h) into Chrome trace JSON,
+// open it in chrome://tracing or ui.perfetto.dev.
+//
+// Build on Linux from the Lightsaber directory:
+//   g++ -std=c++17 -O2 -o trace2json tools/trace/trace2json.cpp
+//
+// Usage:
+//   trace2json [serial.log] > trace.json
+//
+// Reads the serial log (stdin without a file), other lines around the dump
+// are ignored, the last dump in the log wins. Cycle counts are unwrapped
+// per core, the cores' counters are not synchronised, so events of
+// different cores may be off against each other by a few microseconds.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+
+struct Event {
+  uint32_t seq;
+  uint32_t cycles;
+  unsigned id;
+  char kind;
+  unsigned core;
+  uint32_t arg;
+};
+
+
+// JSON string body, names come from the firmware
+std::string quote(const std::string &s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out;
+}
+
+
+int main(int argc, char **argv) {
+  FILE *in = argc > 1 ? fopen(argv[1], "r") : stdin;
+  if (in == nullptr) {
+    fprintf(stderr, "can't read %s\n", argv[1]);
+    return 1;
+  }
+
+  std::vector<Event> events;
+  std::map<unsigned, std::string> names;
+  unsigned cyclesPerUs = 0;
+  bool inDump = false;
+  char line[256];
+
+  while (fgets(line, sizeof(line), in)) {
+    const char *p = strstr(line, "trace ");
+    if (p == nullptr)
+      continue;
+    p += 6;
+    unsigned count, id;
+    char name[128];
+    Event e;
+
+    if (sscanf(p, "begin %u %u", &count, &cyclesPerUs) == 2) {
+      events.clear();
+      names.clear();
+      inDump = true;
+    } else if (strncmp(p, "end", 3) == 0) {
+      inDump = false;
+    } else if (!inDump) {
+      continue;
+    } else if (sscanf(p, "name %u %127[^\r\n]", &id, name) == 2) {
+      names[id] = name;
+    } else if (sscanf(p, "%x %x %u %c %u %x", &e.seq, &e.cycles, &e.id, &e.kind, &e.core, &e.arg) == 6) {
+      events.push_back(e);
+    }
+  }
+  if (in != stdin)
+    fclose(in);
+
+  if (cyclesPerUs == 0) {
+    fprintf(stderr, "no trace dump found\n");
+    return 1;
+  }
+
+  // unwrap the 32 bit counters per core, time 0 is the first event
+  std::map<unsigned, uint32_t> last;
+  std::map<unsigned, uint64_t> time;
+  std::vector<uint64_t> stamps;
+  for (const Event &e : events) {
+    if (last.count(e.core))
+      time[e.core] += (uint32_t)(e.cycles - last[e.core]);
+    else
+      time[e.core] = e.cycles;
+    last[e.core] = e.cycles;
+    stamps.push_back(time[e.core]);
+  }
+  uint64_t origin = UINT64_MAX;
+  for (uint64_t t : stamps)
+    origin = t < origin ? t : origin;
+
+  printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  bool first = true;
+  for (const auto &core : last) {
+    printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"core %u\"}}",
+           first ? "" : ",\n", core.first, core.first);
+    first = false;
+  }
+  for (size_t i = 0; i < events.size(); i++) {
+    const Event &e = events[i];
+    std::string name = names.count(e.id) ? names[e.id] : "event " + std::to_string(e.id);
+    double ts = (double)(stamps[i] - origin) / cyclesPerUs;
+
+    printf("%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,", first ? "" : ",\n",
+           quote(name).c_str(), e.kind, ts, e.core);
+    if (e.kind == 'C')
+      printf("\"args\":{\"value\":%u}}", e.arg);
+    else
+      printf("%s\"args\":{\"arg\":%u}}", e.kind == 'i' ? "\"s\":\"t\"," : "", e.arg);
+    first = false;
+  }
+  printf("\n]}\n");
+  fprintf(stderr, "%zu events, %u cycles/us\n", events.size(), cyclesPerUs);
+  return 0;
+}
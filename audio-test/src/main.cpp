@@ -19,6 +19,8 @@
 
 #include "AudioTools.h"
 #include "AudioCodecs/CodecMP3Helix.h"
+#include "ReadAheadStream.h"
+#include "BootSequencer.h"
 
 
 // Our configuration structure.
@@ -61,14 +63,20 @@ Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_GRB + NEO_KHZ800);
 
 
 
-File audioFile;
+// the mp3 file is read ahead in 4k blocks by a task on core 0, so flash
+// latency does not end up inside the decoder
+#define READAHEAD_WATERMARK 3   // blocks kept buffered
+
+ReadAheadStream audioStream;
 MetaDataPrint outMeta; // final output of metadata
 I2SStream i2s; // I2S output
 EncodedAudioStream out2dec(&i2s, new MP3DecoderHelix()); // Decoding stream
 MultiOutput out(outMeta, out2dec);
-StreamCopy copier(out, audioFile); // copy url to decoder
+StreamCopy copier(out, audioStream); // copy file to decoder
 
 void playFile(const char * filename);
+void initConfig(const char * filename);
+void ensureAudio();
 
 // random hum sounds
 long randNumber;
@@ -90,6 +98,7 @@ void onPressed()
 {
     Serial.printf("Button pressed\n");
 
+    ensureAudio();
     if (!bladeIsOn) {
       Serial.printf("Turn on Blade '%c' %s\n", config.color[0], config.color );
 
@@ -172,12 +181,11 @@ void printMetaData(MetaDataType type, const char* str, int len){
 
 void playFile(const char * filename) {
 
-  // close the old file
-  audioFile.close();
-  // load the new one
-  audioFile = SPIFFS.open(filename, "r");
+  // load the new one, the old file is closed by the stream
+  File audioFile = SPIFFS.open(filename, "r");
+  audioStream.open(audioFile);
 
-  if (audioFile.available()) {
+  if (audioFile) {
     // setup I2S based on sampling rate provided by decoder
     out2dec.setNotifyAudioChange(i2s);
     out2dec.begin();
@@ -229,27 +237,43 @@ void initConfig(const char * filename) {
 
 
 
-void setup(){
+// init phases, timed by the boot sequencer. SPIFFS, the config and the
+// decoder are lazy, the first ignition brings them in.
+BootSequencer boot([]() -> uint32_t { return micros(); });
+int bootConfig;
+int bootAudio;
+
+void printLine(const char *line) {
+  Serial.println(line);
+}
+
+bool initSerial() {
   Serial.begin(115200);
 
   Serial.println();
   Serial.println(">>> EasyButton multiple onSequence example <<<");
+  return true;
+}
 
-  // mount SPIFF
-  SPIFFS.begin();
-
-  // read config file
-  initConfig(cfgfile);
+bool initSpiffs() {
+  return SPIFFS.begin();
+}
 
-  // Initialize the button.
+bool initButton() {
   button.begin();
   button.onPressed(onPressed);
   button.onPressedFor(1000, onPressedForDuration);
+  return true;
+}
 
-  // init neopixel
+bool initPixels() {
   pixels.begin(); // INITIALIZE NeoPixel strip object (REQUIRED)
+  return true;
+}
+
+bool initAudio() {
+  audioStream.begin(READAHEAD_WATERMARK);
 
-  // --------- Audio Init Section -------
   //  AudioLogger::instance().begin(Serial, AudioLogger::Info);  
   // setup metadata
   outMeta.setCallback(printMetaData);
@@ -263,16 +287,47 @@ void setup(){
   // setup I2S based on sampling rate provided by decoder
   out2dec.setNotifyAudioChange(i2s);
   out2dec.begin();
-  // --------- End Audio Init Section -------
-  
+  return true;
+}
+
+// bring up config and audio on first use and print how long that took
+void ensureAudio() {
+  if (boot.state(bootAudio) != BootSequencer::PENDING)
+    return;
+  boot.ensure(bootConfig);
+  boot.ensure(bootAudio);
+  boot.report(printLine);
+}
+
+
+void setup(){
+  int serial = boot.add("serial", initSerial);
+  int spiffs = boot.add("spiffs", initSpiffs, 1u << serial, true);
+  bootConfig = boot.add("config", []() { initConfig(cfgfile); return true; }, 1u << spiffs, true);
+  boot.add("button", initButton, 1u << serial);
+  boot.add("pixels", initPixels);
+  bootAudio = boot.add("audio", initAudio, 1u << spiffs, true);
+
+  boot.run();
+  boot.report(printLine);
 }
 
 
+uint32_t reportedStalls = 0;
+unsigned long lastReport = 0;
+
 void loop(){
   
   // Continuously read the status of the button.
   button.read();
 
+  // report read-ahead stalls at most once a second
+  if (audioStream.stalls() != reportedStalls && millis() - lastReport > 1000) {
+    reportedStalls = audioStream.stalls();
+    lastReport = millis();
+    Serial.printf("read-ahead stalls %u\n", reportedStalls);
+  }
+
   // pixel
   pixelLoop();
 
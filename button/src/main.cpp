@@ -14,11 +14,14 @@
 
 #include <AudioTools.h>
 #include "AudioCodecs/CodecMP3Helix.h"
+#include "ReadAheadStream.h"
+#include "BootSequencer.h"
 
 
 // forward declarations
 void callbackInit();
 Stream* callbackStream();
+void ensureAudio();
 
 // data
 // const int chipSelect=PIN_CS;
@@ -26,14 +29,14 @@ AudioSourceCallback source(callbackStream,callbackInit);
 I2SStream i2s;
 MP3DecoderHelix decoder;
 AudioPlayer player(source, i2s, decoder);
-File audioFile;
+// the player reads through a read-ahead buffer filled by a task on core 0
+ReadAheadStream audioStream;
 
 const char *fileOnSound = "/SaberOn.mp3";
 
 void callbackInit() {
 
-  audioFile = SPIFFS.open(fileOnSound, "r");
-  if (audioFile) {
+  if (SPIFFS.exists(fileOnSound)) {
     Serial.printf("Load Sound File %s\n", fileOnSound);    
   } else {
     Serial.println("failed to read sound file)");
@@ -44,10 +47,10 @@ void callbackInit() {
 
 
 Stream* callbackStream() {
-  auto lastFile = audioFile;
-  audioFile = audioFile.openNextFile();
-  lastFile.close();
-  return &audioFile;
+  // a fresh handle for every replay, the stream owns it and closes the
+  // last one
+  audioStream.open(SPIFFS.open(fileOnSound, "r"));
+  return &audioStream;
 }
 
 
@@ -107,6 +110,7 @@ void onPressed()
   if (millis() - lastEvent > 5000) {
     Serial.printf("%u Button pressed\n", millis() - lastEvent);
     lastEvent = millis();
+    ensureAudio();
     if (!bladeIsOn) {
       Serial.printf("Turn on Blade '%c' %s\n", config.color[0], config.color );
 
@@ -212,25 +216,44 @@ void initConfig() {
 
 
 
-void setup()
-{
+// init phases, timed by the boot sequencer. SPIFFS, the config and the
+// player are lazy, the first ignition brings them in.
+BootSequencer boot([]() -> uint32_t { return micros(); });
+int bootConfig;
+int bootAudio;
+
+void printLine(const char *line) {
+  Serial.println(line);
+}
+
+bool initSerial() {
   // Initialize Serial for debuging purposes.
   Serial.begin(BAUDRATE);
 
   Serial.println();
   Serial.println(">>> EasyButton multiple onSequence example <<<");
+  return true;
+}
 
-  SPIFFS.begin();
-  initConfig();
+bool initSpiffs() {
+  return SPIFFS.begin();
+}
 
-  // Initialize the button.
+bool initButton() {
   button.begin();
 
   button.onPressed(onPressed);
   button.onPressedFor(1000, onPressedForDuration);
+  return true;
+}
 
+bool initPixels() {
   pixels.begin(); // INITIALIZE NeoPixel strip object (REQUIRED)
+  return true;
+}
 
+bool initAudio() {
+  audioStream.begin();
 
   AudioLogger::instance().begin(Serial, AudioLogger::Info);
 
@@ -240,8 +263,30 @@ void setup()
 
   // setup player
   player.setMetadataCallback(callbackPrintMetaData);
-  player.begin();
+  return player.begin();
+}
+
+// bring up config and audio on first use and print how long that took
+void ensureAudio() {
+  if (boot.state(bootAudio) != BootSequencer::PENDING)
+    return;
+  boot.ensure(bootConfig);
+  boot.ensure(bootAudio);
+  boot.report(printLine);
+}
 
+
+void setup()
+{
+  int serial = boot.add("serial", initSerial);
+  int spiffs = boot.add("spiffs", initSpiffs, 1u << serial, true);
+  bootConfig = boot.add("config", []() { initConfig(); return true; }, 1u << spiffs, true);
+  boot.add("button", initButton, 1u << serial);
+  boot.add("pixels", initPixels);
+  bootAudio = boot.add("audio", initAudio, 1u << spiffs, true);
+
+  boot.run();
+  boot.report(printLine);
 }
 
 
@@ -252,6 +297,7 @@ void loop()
   // Continuously read the status of the button.
   button.read();
 
-  player.copy();
+  if (boot.done(bootAudio))
+    player.copy();
 
-}
\ No newline at end of file
+}